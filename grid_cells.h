@@ -0,0 +1,117 @@
+/**
+ * @file grid_cells.h
+ * @brief Per-cell progress marks, packed two bits per cell.
+ *
+ * Cells are indexed row-major (row * cols + col). A 10x6 box fits in two
+ * 64-bit words, and the whole table for the largest grid is 1 KB. No Windows
+ * dependencies.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "grid_geometry.h"
+
+/**
+ * @brief Progress of one cell. Advancing a cell walks this list and wraps.
+ */
+enum CellState {
+    CELL_EMPTY = 0,
+    CELL_EGG = 1,
+    CELL_HATCHED = 2,
+    CELL_FLAGGED = 3,
+};
+const int CELL_STATE_COUNT = 4;
+
+const int CELL_MAX_COUNT = GRID_MAX_CELLS * GRID_MAX_CELLS;
+const int CELLS_PER_WORD = 32;
+
+/**
+ * @brief State of every cell, plus a count of the non-empty ones so renderers
+ *        can skip the cell pass entirely when nothing is marked.
+ */
+struct CellStates {
+    uint64_t words[CELL_MAX_COUNT / CELLS_PER_WORD] = {};
+    int marked = 0;
+};
+
+inline CellState CellStatesGet(const CellStates& states, int index) {
+    return (CellState)((states.words[index / CELLS_PER_WORD] >> (2 * (index % CELLS_PER_WORD))) & 3);
+}
+
+inline void CellStatesSet(CellStates& states, int index, CellState state) {
+    const CellState previous = CellStatesGet(states, index);
+    const int shift = 2 * (index % CELLS_PER_WORD);
+    uint64_t& word = states.words[index / CELLS_PER_WORD];
+    word = (word & ~((uint64_t)3 << shift)) | ((uint64_t)state << shift);
+    states.marked += (state != CELL_EMPTY) - (previous != CELL_EMPTY);
+}
+
+/**
+ * @brief Moves a cell to its next state and returns it.
+ */
+inline CellState CellStatesAdvance(CellStates& states, int index) {
+    const CellState next = (CellState)((CellStatesGet(states, index) + 1) % CELL_STATE_COUNT);
+    CellStatesSet(states, index, next);
+    return next;
+}
+
+/**
+ * @brief Returns the first of the first @p cellCount cells in @p state, or -1.
+ *        Scans a whole word (32 cells) per step.
+ */
+inline int CellStatesFindFirst(const CellStates& states, int cellCount, CellState state) {
+    const uint64_t lowBits = 0x5555555555555555ull;
+    const uint64_t pattern = lowBits * (uint64_t)state;
+    const int words = (cellCount + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    for (int w = 0; w < words; ++w) {
+        // A cell matches when both of its bits agree with the pattern.
+        const uint64_t diff = states.words[w] ^ pattern;
+        const uint64_t match = ~(diff | (diff >> 1)) & lowBits;
+        if (match) {
+            int bit = 0;
+            while (!((match >> bit) & 1)) ++bit;
+            const int index = w * CELLS_PER_WORD + bit / 2;
+            return index < cellCount ? index : -1;
+        }
+    }
+    return -1;
+}
+
+inline void CellStatesClear(CellStates& states) {
+    states = CellStates();
+}
+
+/**
+ * @brief Number of bytes that hold the first @p cellCount cells, for persistence.
+ */
+inline int CellStatesByteCount(int cellCount) {
+    return (cellCount * 2 + 7) / 8;
+}
+
+/**
+ * @brief Copies the packed states of the first @p cellCount cells into @p bytes
+ *        (CellStatesByteCount(cellCount) bytes), little-endian.
+ */
+inline void CellStatesSave(const CellStates& states, int cellCount, uint8_t* bytes) {
+    const int byteCount = CellStatesByteCount(cellCount);
+    for (int i = 0; i < byteCount; ++i) {
+        bytes[i] = (uint8_t)(states.words[i / 8] >> (8 * (i % 8)));
+    }
+    if (cellCount % 4 != 0) {
+        bytes[byteCount - 1] &= (uint8_t)((1u << (2 * (cellCount % 4))) - 1);
+    }
+}
+
+/**
+ * @brief Restores states written by CellStatesSave. Cells past @p cellCount are cleared.
+ */
+inline void CellStatesLoad(CellStates& states, int cellCount, const uint8_t* bytes) {
+    CellStatesClear(states);
+    uint8_t packed[CELL_MAX_COUNT / 4] = {};
+    memcpy(packed, bytes, CellStatesByteCount(cellCount));
+    for (int i = 0; i < cellCount; ++i) {
+        CellStatesSet(states, i, (CellState)((packed[i / 4] >> (2 * (i % 4))) & 3));
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * @file grid_geometry.h
+ * @brief Integer cell edges shared by the renderer and hit-testing.
+ *
+ * Edges are computed once per client size with exact integer arithmetic, so the
+ * lines that are drawn, the label rectangles and the cell returned for a point
+ * can never disagree by a pixel. Grid points locate things relative to the
+ * cells, through the same tables. No Windows dependencies.
+ */
+
+#pragma once
+
+#include <math.h>
+
+// Upper bound on either grid dimension; edge tables are sized for it.
+const int GRID_MAX_CELLS = 64;
+
+/**
+ * @brief Column and row boundaries for a cols x rows grid filling width x height.
+ *
+ * Column c spans [colEdge[c], colEdge[c + 1]); colEdge[0] is 0 and
+ * colEdge[cols] is the width. Rows work the same way. Interior edges are where
+ * the grid lines are drawn.
+ */
+struct GridGeometry {
+    int cols = 0;
+    int rows = 0;
+    int width = 0;
+    int height = 0;
+    int colEdge[GRID_MAX_CELLS + 1] = {};
+    int rowEdge[GRID_MAX_CELLS + 1] = {};
+};
+
+/**
+ * @brief Recomputes the edge tables. edge[i] = floor(i * size / count).
+ * @return false (leaving an empty geometry) if the dimensions are out of range.
+ */
+inline bool GridGeometryUpdate(GridGeometry& geometry, int width, int height, int cols, int rows) {
+    if (cols <= 0 || rows <= 0 || cols > GRID_MAX_CELLS || rows > GRID_MAX_CELLS || width < 0 || height < 0) {
+        geometry = GridGeometry();
+        return false;
+    }
+    geometry.cols = cols;
+    geometry.rows = rows;
+    geometry.width = width;
+    geometry.height = height;
+    for (int i = 0; i <= cols; ++i) {
+        geometry.colEdge[i] = (int)((long long)i * width / cols);
+    }
+    for (int i = 0; i <= rows; ++i) {
+        geometry.rowEdge[i] = (int)((long long)i * height / rows);
+    }
+    return true;
+}
+
+/**
+ * @brief Returns true if the geometry was built for this size and grid.
+ */
+inline bool GridGeometryMatches(const GridGeometry& geometry, int width, int height, int cols, int rows) {
+    return geometry.width == width && geometry.height == height && geometry.cols == cols && geometry.rows == rows;
+}
+
+/**
+ * @brief Maps a coordinate to the cell that contains it, in O(1).
+ *
+ * Inverting floor(i * size / count) <= p gives i = floor(((p + 1) * count - 1) / size),
+ * which always agrees with the edge table.
+ */
+inline int GridCellIndex(int p, int size, int count) {
+    return (int)(((long long)(p + 1) * count - 1) / size);
+}
+
+/**
+ * @brief Finds the cell containing the point (x, y).
+ * @return false if the point lies outside the grid.
+ */
+inline bool GridCellFromPoint(const GridGeometry& geometry, int x, int y, int* col, int* row) {
+    if (x < 0 || y < 0 || x >= geometry.width || y >= geometry.height) {
+        return false;
+    }
+    *col = GridCellIndex(x, geometry.width, geometry.cols);
+    *row = GridCellIndex(y, geometry.height, geometry.rows);
+    return true;
+}
+
+/**
+ * @brief Returns the cell's half-open bounds as left, top, right, bottom.
+ */
+inline void GridCellBounds(const GridGeometry& geometry, int col, int row, int* left, int* top, int* right, int* bottom) {
+    *left = geometry.colEdge[col];
+    *top = geometry.rowEdge[row];
+    *right = geometry.colEdge[col + 1];
+    *bottom = geometry.rowEdge[row + 1];
+}
+
+/**
+ * @brief A position in grid space. The integer parts of col and row name the
+ *        cell; the fractions are the offset across it. Unlike client pixels,
+ *        a grid point stays on the same spot of the grid when it is resized.
+ */
+struct GridPoint {
+    double col = 0.0;
+    double row = 0.0;
+};
+
+/**
+ * @brief Maps a coordinate to grid space along one axis through the edge table,
+ *        using the pixel's center so GridAxisToClient maps it back exactly.
+ */
+inline double GridAxisFromClient(const int* edges, int count, int size, int p) {
+    if (size <= 0) {
+        return 0.0;
+    }
+    p = p < 0 ? 0 : (p >= size ? size - 1 : p);
+    const int cell = GridCellIndex(p, size, count);
+    const int span = edges[cell + 1] - edges[cell];
+    return cell + (span > 0 ? (p + 0.5 - edges[cell]) / span : 0.5);
+}
+
+/**
+ * @brief Maps a grid-space coordinate back to the pixel that contains it along
+ *        one axis: the integer part picks the cell through the edge table and
+ *        the fraction is scaled by that cell's span. Coordinates outside the
+ *        grid are clamped to its border cells.
+ */
+inline int GridAxisToClient(const int* edges, int count, double g) {
+    if (count <= 0) {
+        return 0;
+    }
+    int cell = (int)floor(g);
+    cell = cell < 0 ? 0 : (cell >= count ? count - 1 : cell);
+    return (int)floor(edges[cell] + (g - cell) * (edges[cell + 1] - edges[cell]));
+}
+
+/**
+ * @brief Converts a client point to grid space. Points outside the grid are
+ *        clamped to its border cells.
+ */
+inline GridPoint GridPointFromClient(const GridGeometry& geometry, int x, int y) {
+    GridPoint point;
+    point.col = GridAxisFromClient(geometry.colEdge, geometry.cols, geometry.width, x);
+    point.row = GridAxisFromClient(geometry.rowEdge, geometry.rows, geometry.height, y);
+    return point;
+}
+
+/**
+ * @brief Converts a grid point to the client pixel that contains it.
+ */
+inline void GridPointToClient(const GridGeometry& geometry, const GridPoint& point, int* x, int* y) {
+    *x = GridAxisToClient(geometry.colEdge, geometry.cols, point.col);
+    *y = GridAxisToClient(geometry.rowEdge, geometry.rows, point.row);
+}
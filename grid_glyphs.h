@@ -0,0 +1,290 @@
+/**
+ * @file grid_glyphs.h
+ * @brief A signed-distance-field atlas for the digits 0-9, drawn at any size.
+ *
+ * The atlas itself is platform-independent: the Windows side rasterizes the
+ * digits once with GDI at a fixed reference size and the distance field is
+ * built from that mask. The field is resampled into a coverage strip at
+ * whatever height the grid needs and labels are blitted from that strip, so
+ * resizing never does any font work.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+#include "grid_raster.h"
+
+/**
+ * @brief The ten digits resampled from the distance field at one height, as 8-bit coverage.
+ *
+ * Every label in a frame has the same height, so the field is sampled once per
+ * height and labels are blitted from here. Each digit keeps only its ink box.
+ * The owner keeps one next to its atlas and GlyphAtlasStrip refreshes it when
+ * the height changes; reset it to GlyphStrip() whenever the atlas is rebuilt.
+ */
+struct GlyphStrip {
+    std::vector<uint8_t> coverage; // width * height, row-major; 0-255.
+    int width = 0;
+    int height = 0;
+    int inkTop = 0;                // Top row relative to the advance box's top edge; may be negative.
+    int inkX[10] = {};             // Left edge of each digit's ink box within the strip.
+    int inkLeft[10] = {};          // The same edge relative to the advance box's left edge.
+    int inkWidth[10] = {};
+    int fontHeight = 0;            // Height the strip was sampled at; 0 when empty.
+    bool antialias = false;
+};
+
+/**
+ * @brief Signed distance to the nearest glyph edge for the ten digits, laid out
+ *        side by side in one strip.
+ *
+ * Each glyph cell is its advance width plus @c pad pixels on every side, so the
+ * field extends past the ink. Distances are in reference pixels, stored as
+ * 128 + d * 127 / spread and clamped; values above 128 are inside the glyph.
+ */
+struct GlyphAtlas {
+    std::vector<uint8_t> distance; // width * height, row-major.
+    int width = 0;
+    int height = 0;                // Line height plus padding above and below.
+    int pad = 0;                   // Padding around every glyph cell; also the field's spread.
+    int glyphX[10] = {};           // Left edge of each digit's advance box within the strip.
+    int glyphWidth[10] = {};       // Advance width of each digit.
+    int fontHeight = 0;            // Reference font height the atlas was built at; 0 when empty.
+};
+
+/**
+ * @brief Lays out the strip from the digit advances and zeroes the field.
+ */
+inline void GlyphAtlasReset(GlyphAtlas& atlas, int fontHeight, const int advances[10], int lineHeight, int pad) {
+    int x = 0;
+    for (int d = 0; d < 10; ++d) {
+        atlas.glyphX[d] = x + pad;
+        atlas.glyphWidth[d] = advances[d];
+        x += advances[d] + 2 * pad;
+    }
+    atlas.width = x;
+    atlas.height = lineHeight + 2 * pad;
+    atlas.pad = pad;
+    atlas.fontHeight = fontHeight;
+    atlas.distance.assign((size_t)atlas.width * atlas.height, 0);
+}
+
+/**
+ * @brief Builds the distance field from an 8-bit coverage mask with the atlas's
+ *        layout (glyph ink placed at glyphX, pad rows down).
+ *
+ * Brute force over a (2 * pad + 1)^2 window per pixel. It only runs once per
+ * process, at the reference size, and takes a few milliseconds.
+ */
+inline void GlyphAtlasBuildSdf(GlyphAtlas& atlas, const uint8_t* coverage) {
+    const int spread = atlas.pad;
+    for (int y = 0; y < atlas.height; ++y) {
+        for (int x = 0; x < atlas.width; ++x) {
+            const bool inside = coverage[(size_t)y * atlas.width + x] >= 128;
+            int best = (spread + 1) * (spread + 1);
+            for (int dy = -spread; dy <= spread; ++dy) {
+                const int sy = y + dy;
+                if (sy < 0 || sy >= atlas.height) continue;
+                for (int dx = -spread; dx <= spread; ++dx) {
+                    const int sx = x + dx;
+                    if (sx < 0 || sx >= atlas.width) continue;
+                    const int d2 = dx * dx + dy * dy;
+                    if (d2 < best && (coverage[(size_t)sy * atlas.width + sx] >= 128) != inside) {
+                        best = d2;
+                    }
+                }
+            }
+            // The edge lies halfway between a pixel and its nearest opposite neighbour.
+            const double edge = sqrt((double)best) - 0.5;
+            const double d = inside ? edge : -edge;
+            const double encoded = 128.0 + d * 127.0 / spread;
+            atlas.distance[(size_t)y * atlas.width + x] =
+                (uint8_t)(encoded < 0.0 ? 0.0 : (encoded > 255.0 ? 255.0 : encoded + 0.5));
+        }
+    }
+}
+
+/**
+ * @brief Resamples the field into @p strip at @p fontHeight, unless the strip
+ *        already holds that height and edge mode.
+ *
+ * Only the reference-pixel box whose encoded distance can produce coverage is
+ * sampled, one bilinear lookup per destination pixel in 16.16 fixed point.
+ * @param antialias Use the distance for a one-pixel soft edge; otherwise threshold
+ *        it, so no partial pixels are produced.
+ */
+inline void GlyphAtlasStrip(GlyphStrip& strip, const GlyphAtlas& atlas, int fontHeight, bool antialias) {
+    if (strip.fontHeight == fontHeight && strip.antialias == antialias) {
+        return;
+    }
+    strip = GlyphStrip();
+    strip.fontHeight = fontHeight;
+    strip.antialias = antialias;
+    if (atlas.fontHeight <= 0 || fontHeight <= 0) {
+        return;
+    }
+
+    const double scale = (double)fontHeight / atlas.fontHeight; // Destination pixels per reference pixel.
+    // One encoded step is spread / 127 reference pixels, or that times scale on screen.
+    const double pixelsPerStep = atlas.pad * scale / 127.0;
+    // Encoded values at or below this are at least half a destination pixel outside the ink.
+    const int threshold = antialias ? (int)floor(128.0 - 0.5 / pixelsPerStep) : 127;
+
+    // Ink bounds per digit in reference pixels; bilinear taps reach one pixel further.
+    int refLeft[10], refRight[10];
+    int refTop = atlas.height, refBottom = 0;
+    for (int d = 0; d < 10; ++d) {
+        const int cellLeft = atlas.glyphX[d] - atlas.pad;
+        const int cellRight = atlas.glyphX[d] + atlas.glyphWidth[d] + atlas.pad;
+        refLeft[d] = cellRight;
+        refRight[d] = cellLeft;
+        for (int v = 0; v < atlas.height; ++v) {
+            const uint8_t* row = &atlas.distance[(size_t)v * atlas.width];
+            for (int u = cellLeft; u < cellRight; ++u) {
+                if (row[u] > threshold) {
+                    if (u < refLeft[d]) refLeft[d] = u;
+                    if (u + 1 > refRight[d]) refRight[d] = u + 1;
+                    if (v < refTop) refTop = v;
+                    if (v + 1 > refBottom) refBottom = v + 1;
+                }
+            }
+        }
+    }
+    if (refTop >= refBottom) {
+        return; // No ink at all.
+    }
+
+    // Reference coordinate u maps to destination pixel centre (u - origin + 0.5) * scale - 0.5.
+    const int top = (int)floor((refTop - 1 - atlas.pad + 0.5) * scale - 0.5);
+    const int bottom = (int)ceil((refBottom + 1 - atlas.pad + 0.5) * scale - 0.5);
+    strip.inkTop = top;
+    strip.height = bottom - top;
+    for (int d = 0; d < 10; ++d) {
+        if (refLeft[d] >= refRight[d]) {
+            continue;
+        }
+        strip.inkLeft[d] = (int)floor((refLeft[d] - 1 - atlas.glyphX[d] + 0.5) * scale - 0.5);
+        strip.inkWidth[d] = (int)ceil((refRight[d] + 1 - atlas.glyphX[d] + 0.5) * scale - 0.5) - strip.inkLeft[d];
+        strip.inkX[d] = strip.width;
+        strip.width += strip.inkWidth[d];
+    }
+    strip.coverage.assign((size_t)strip.width * strip.height, 0);
+
+    const int64_t step = (int64_t)floor(65536.0 / scale + 0.5);
+    const int64_t maxV = (int64_t)(atlas.height - 1) << 16;
+    // Coverage is (d + 0.5) * 255 rounded, with d the distance in destination pixels.
+    const int64_t gain = (int64_t)floor(pixelsPerStep * 255.0 * 65536.0 + 0.5);
+    for (int d = 0; d < 10; ++d) {
+        const int cellLeft = atlas.glyphX[d] - atlas.pad;
+        const int64_t minU = (int64_t)cellLeft << 16;
+        const int64_t maxU = (int64_t)(atlas.glyphX[d] + atlas.glyphWidth[d] + atlas.pad - 1) << 16;
+        const int64_t u0 = (int64_t)floor(((strip.inkLeft[d] + 0.5) / scale + atlas.glyphX[d] - 0.5) * 65536.0 + 0.5);
+        for (int y = 0; y < strip.height; ++y) {
+            int64_t v = (int64_t)floor(((top + y + 0.5) / scale + atlas.pad - 0.5) * 65536.0 + 0.5);
+            v = v < 0 ? 0 : (v > maxV ? maxV : v);
+            const int vi = (int)(v >> 16);
+            const int fv = (int)((v >> 8) & 0xFF);
+            const uint8_t* row0 = &atlas.distance[(size_t)vi * atlas.width];
+            const uint8_t* row1 = (v < maxV) ? row0 + atlas.width : row0;
+            uint8_t* out = &strip.coverage[(size_t)y * strip.width + strip.inkX[d]];
+            int64_t u = u0;
+            for (int x = 0; x < strip.inkWidth[d]; ++x, u += step) {
+                const int64_t uc = u < minU ? minU : (u > maxU ? maxU : u);
+                const int ui = (int)(uc >> 16);
+                const int ui1 = (uc < maxU) ? ui + 1 : ui;
+                const int fu = (int)((uc >> 8) & 0xFF);
+                const int t = row0[ui] * (256 - fu) + row0[ui1] * fu;
+                const int b = row1[ui] * (256 - fu) + row1[ui1] * fu;
+                const int64_t sample = (int64_t)t * (256 - fv) + (int64_t)b * fv; // Encoded distance, 16.16.
+                if (!antialias) {
+                    out[x] = sample >= (128 << 16) ? 255 : 0;
+                    continue;
+                }
+                const int64_t cov = ((((sample - (128 << 16)) * gain) >> 16) + (128 << 16)) >> 16;
+                out[x] = (uint8_t)(cov < 0 ? 0 : (cov > 255 ? 255 : cov));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns the advance width of a run of ASCII digits in reference pixels.
+ *        Other characters are skipped.
+ */
+inline int GlyphAtlasTextWidth(const GlyphAtlas& atlas, const char* text) {
+    int width = 0;
+    for (; *text; ++text) {
+        if (*text >= '0' && *text <= '9') {
+            width += atlas.glyphWidth[*text - '0'];
+        }
+    }
+    return width;
+}
+
+/**
+ * @brief Composites one glyph of the strip with the top-left of its advance box
+ *        at (x, y), clipped to the surface's clip.
+ */
+inline void RasterBlitGlyph(RasterSurface& surface, const GlyphStrip& strip, int digit, int x, int y, uint32_t color) {
+    const int left = x + strip.inkLeft[digit];
+    const int top = y + strip.inkTop;
+    const int x0 = left > surface.clipLeft ? left : surface.clipLeft;
+    const int y0 = top > surface.clipTop ? top : surface.clipTop;
+    const int x1 = left + strip.inkWidth[digit] < surface.clipRight ? left + strip.inkWidth[digit] : surface.clipRight;
+    const int y1 = top + strip.height < surface.clipBottom ? top + strip.height : surface.clipBottom;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    for (int py = y0; py < y1; ++py) {
+        const uint8_t* cov = &strip.coverage[(size_t)(py - top) * strip.width + strip.inkX[digit] + (x0 - left)];
+        uint32_t* row = surface.pixels + (intptr_t)py * surface.stride;
+        for (int px = x0; px < x1; ++px, ++cov) {
+            if (*cov == 255) {
+                row[px] = RasterBlendOver(color, row[px]);
+            } else if (*cov != 0) {
+                row[px] = RasterBlendOver(RasterScaleColor(color, *cov), row[px]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Draws a run of ASCII digits at @p fontHeight with its top-left corner at (x, y).
+ *
+ * Advances stay fractional; each glyph lands on the nearest whole pixel so it
+ * can be blitted from the strip unchanged.
+ * @param strip The atlas's strip cache; resampled here if it is for another height.
+ */
+inline void RasterDrawGlyphText(RasterSurface& surface, const GlyphAtlas& atlas, GlyphStrip& strip, const char* text,
+                                double x, double y, int fontHeight, uint32_t color, bool antialias) {
+    GlyphAtlasStrip(strip, atlas, fontHeight, antialias);
+    const double scale = (double)fontHeight / atlas.fontHeight;
+    const int py = (int)floor(y + 0.5);
+    for (; *text; ++text) {
+        if (*text < '0' || *text > '9') {
+            continue;
+        }
+        const int digit = *text - '0';
+        RasterBlitGlyph(surface, strip, digit, (int)floor(x + 0.5), py, color);
+        x += atlas.glyphWidth[digit] * scale;
+    }
+}
+
+/**
+ * @brief Draws text centered in [left, right) x [top, bottom), like DT_CENTER | DT_VCENTER.
+ */
+inline void RasterDrawGlyphTextCentered(RasterSurface& surface, const GlyphAtlas& atlas, GlyphStrip& strip, const char* text,
+                                        int fontHeight, int left, int top, int right, int bottom, uint32_t color,
+                                        bool antialias) {
+    if (atlas.fontHeight <= 0 || fontHeight <= 0) {
+        return;
+    }
+    const double scale = (double)fontHeight / atlas.fontHeight;
+    const double lineHeight = (atlas.height - 2 * atlas.pad) * scale;
+    // Snap the origin to whole pixels so a label looks the same in every column.
+    const double x = floor(left + ((right - left) - GlyphAtlasTextWidth(atlas, text) * scale) / 2);
+    const double y = floor(top + ((bottom - top) - lineHeight) / 2);
+    RasterDrawGlyphText(surface, atlas, strip, text, x, y, fontHeight, color, antialias);
+}
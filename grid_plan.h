@@ -0,0 +1,244 @@
+/**
+ * @file grid_plan.h
+ * @brief Compiles a scene into a display list and replays it against a backend.
+ *
+ * Building the plan resolves every coordinate, color and label string once.
+ * As long as the scene's inputs are unchanged, a frame is just a walk over the
+ * list that skips operations outside the backend's clip.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "grid_geometry.h"
+#include "grid_cells.h"
+#include "grid_render.h"
+
+enum RenderOpType {
+    RENDER_OP_CLEAR,
+    RENDER_OP_BLEND_RECT,
+    RENDER_OP_GRID_LINES,
+    RENDER_OP_LABEL,
+    RENDER_OP_FILL_CIRCLE,
+};
+
+/**
+ * @brief One primitive with its bounds, [left, right) x [top, bottom). For a
+ *        circle the bounds are its box; for grid lines, the whole grid.
+ */
+struct RenderOp {
+    RenderOpType type;
+    int left;
+    int top;
+    int right;
+    int bottom;
+    uint32_t color;
+    char text[4]; // Label digits, NUL-terminated.
+};
+
+/**
+ * @brief A compiled frame, plus copies of the inputs it was compiled from.
+ *
+ * The plan owns its geometry and cell marks, so it stays valid however the
+ * caller's copies change. The counters show how often frames were served
+ * from the list versus how often it had to be recompiled.
+ */
+struct RenderPlan {
+    std::vector<RenderOp> ops;
+    bool valid = false;
+    GridScene scene = {}; // Points at the plan's own geometry and cells.
+    GridGeometry geometry;
+    CellStates cells;
+    unsigned long rebuilds = 0;
+    unsigned long replays = 0;
+};
+
+/**
+ * @brief Returns true if the plan was compiled from a scene equal to @p scene.
+ */
+inline bool RenderPlanMatches(const RenderPlan& plan, const GridScene& scene) {
+    if (!plan.valid) {
+        return false;
+    }
+    const GridScene& a = plan.scene;
+    const GridGeometry& geometry = *scene.geometry;
+    if (!GridGeometryMatches(plan.geometry, geometry.width, geometry.height, geometry.cols, geometry.rows) ||
+        a.labelAtlas != scene.labelAtlas || a.labelFontHeight != scene.labelFontHeight ||
+        a.dotSet != scene.dotSet || a.dotX != scene.dotX || a.dotY != scene.dotY || a.dotRadius != scene.dotRadius ||
+        a.dotHaloRadius != scene.dotHaloRadius || a.dotHaloColor != scene.dotHaloColor ||
+        a.lineWidth != scene.lineWidth || a.antialias != scene.antialias || a.background != scene.background || a.gridColor != scene.gridColor ||
+        a.labelColor != scene.labelColor || a.dotColor != scene.dotColor ||
+        a.blinkCell != scene.blinkCell || a.blinkColor != scene.blinkColor ||
+        a.hoverCol != scene.hoverCol || a.hoverRow != scene.hoverRow || a.hoverColor != scene.hoverColor ||
+        a.translucent != scene.translucent || a.cellOutlineWidth != scene.cellOutlineWidth ||
+        memcmp(a.cellColors, scene.cellColors, sizeof(a.cellColors)) != 0) {
+        return false;
+    }
+
+    const int marked = scene.cells ? scene.cells->marked : 0;
+    if (plan.cells.marked != marked) {
+        return false;
+    }
+    const int words = (geometry.cols * geometry.rows + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    return marked == 0 || memcmp(plan.cells.words, scene.cells->words, words * sizeof(uint64_t)) == 0;
+}
+
+inline void RenderPlanPush(RenderPlan& plan, RenderOpType type, int left, int top, int right, int bottom, uint32_t color) {
+    RenderOp op = { type, left, top, right, bottom, color, {} };
+    plan.ops.push_back(op);
+}
+
+/**
+ * @brief Pushes a frame @p width pixels thick just inside [left, right) x [top, bottom),
+ *        as four non-overlapping rectangles.
+ */
+inline void RenderPlanPushOutline(RenderPlan& plan, int left, int top, int right, int bottom, int width, uint32_t color) {
+    if (2 * width >= right - left || 2 * width >= bottom - top) {
+        RenderPlanPush(plan, RENDER_OP_BLEND_RECT, left, top, right, bottom, color);
+        return;
+    }
+    RenderPlanPush(plan, RENDER_OP_BLEND_RECT, left, top, right, top + width, color);
+    RenderPlanPush(plan, RENDER_OP_BLEND_RECT, left, bottom - width, right, bottom, color);
+    RenderPlanPush(plan, RENDER_OP_BLEND_RECT, left, top + width, left + width, bottom - width, color);
+    RenderPlanPush(plan, RENDER_OP_BLEND_RECT, right - width, top + width, right, bottom - width, color);
+}
+
+/**
+ * @brief Compiles the scene: background, cell marks, blink cue, hover highlight, lines,
+ *        labels, then the dot and its halo.
+ */
+inline void RenderPlanBuild(RenderPlan& plan, const GridScene& scene) {
+    plan.geometry = *scene.geometry;
+    if (scene.cells) {
+        plan.cells = *scene.cells;
+    } else {
+        CellStatesClear(plan.cells);
+    }
+    plan.scene = scene;
+    plan.scene.geometry = &plan.geometry;
+    plan.scene.cells = &plan.cells;
+    plan.ops.clear(); // Keeps its capacity, so rebuilding at the same grid size doesn't allocate.
+
+    const GridGeometry& geometry = plan.geometry;
+    RenderPlanPush(plan, RENDER_OP_CLEAR, 0, 0, geometry.width, geometry.height, scene.background);
+
+    if (geometry.cols > 0 && geometry.rows > 0) {
+        if (plan.cells.marked > 0) {
+            for (int row = 0; row < geometry.rows; ++row) {
+                for (int col = 0; col < geometry.cols; ++col) {
+                    const CellState state = CellStatesGet(plan.cells, row * geometry.cols + col);
+                    if (state == CELL_EMPTY) {
+                        continue;
+                    }
+                    if (scene.translucent) {
+                        RenderPlanPush(plan, RENDER_OP_BLEND_RECT, geometry.colEdge[col], geometry.rowEdge[row],
+                                       geometry.colEdge[col + 1], geometry.rowEdge[row + 1], scene.cellColors[state]);
+                    } else {
+                        RenderPlanPushOutline(plan, geometry.colEdge[col], geometry.rowEdge[row], geometry.colEdge[col + 1],
+                                              geometry.rowEdge[row + 1], scene.cellOutlineWidth, scene.cellColors[state]);
+                    }
+                }
+            }
+        }
+
+        if (scene.blinkCell >= 0 && scene.blinkCell < geometry.cols * geometry.rows) {
+            const int col = scene.blinkCell % geometry.cols;
+            const int row = scene.blinkCell / geometry.cols;
+            if (scene.translucent) {
+                RenderPlanPush(plan, RENDER_OP_BLEND_RECT, geometry.colEdge[col], geometry.rowEdge[row],
+                               geometry.colEdge[col + 1], geometry.rowEdge[row + 1], scene.blinkColor);
+            } else {
+                RenderPlanPushOutline(plan, geometry.colEdge[col], geometry.rowEdge[row], geometry.colEdge[col + 1],
+                                      geometry.rowEdge[row + 1], scene.cellOutlineWidth, scene.blinkColor);
+            }
+        }
+
+        // The hovered row skips the hovered column so their crossing isn't tinted twice.
+        const bool hoverCol = scene.hoverCol >= 0 && scene.hoverCol < geometry.cols;
+        const bool hoverRow = scene.hoverRow >= 0 && scene.hoverRow < geometry.rows;
+        if (hoverCol) {
+            RenderPlanPush(plan, RENDER_OP_BLEND_RECT, geometry.colEdge[scene.hoverCol], 0,
+                           geometry.colEdge[scene.hoverCol + 1], geometry.height, scene.hoverColor);
+        }
+        if (hoverRow) {
+            const int top = geometry.rowEdge[scene.hoverRow];
+            const int bottom = geometry.rowEdge[scene.hoverRow + 1];
+            const int gapLeft = hoverCol ? geometry.colEdge[scene.hoverCol] : geometry.width;
+            const int gapRight = hoverCol ? geometry.colEdge[scene.hoverCol + 1] : geometry.width;
+            if (gapLeft > 0) {
+                RenderPlanPush(plan, RENDER_OP_BLEND_RECT, 0, top, gapLeft, bottom, scene.hoverColor);
+            }
+            if (gapRight < geometry.width) {
+                RenderPlanPush(plan, RENDER_OP_BLEND_RECT, gapRight, top, geometry.width, bottom, scene.hoverColor);
+            }
+        }
+
+        RenderPlanPush(plan, RENDER_OP_GRID_LINES, 0, 0, geometry.width, geometry.height, scene.gridColor);
+
+        for (int i = 0; i < geometry.cols; ++i) {
+            RenderPlanPush(plan, RENDER_OP_LABEL, geometry.colEdge[i], 0, geometry.colEdge[i + 1], geometry.rowEdge[1], scene.labelColor);
+            snprintf(plan.ops.back().text, sizeof(plan.ops.back().text), "%d", i + 1);
+        }
+
+        // A blended halo only reads as a glow when alpha reaches the screen; under a
+        // color key it would be an opaque dark disk around the dot.
+        if (scene.dotSet && scene.translucent && scene.dotHaloRadius > scene.dotRadius) {
+            RenderPlanPush(plan, RENDER_OP_FILL_CIRCLE, scene.dotX - scene.dotHaloRadius, scene.dotY - scene.dotHaloRadius,
+                           scene.dotX + scene.dotHaloRadius, scene.dotY + scene.dotHaloRadius, scene.dotHaloColor);
+        }
+        if (scene.dotSet) {
+            RenderPlanPush(plan, RENDER_OP_FILL_CIRCLE, scene.dotX - scene.dotRadius, scene.dotY - scene.dotRadius,
+                           scene.dotX + scene.dotRadius, scene.dotY + scene.dotRadius, scene.dotColor);
+        }
+    }
+
+    plan.valid = true;
+    ++plan.rebuilds;
+}
+
+/**
+ * @brief Executes the plan against @p backend. Operations that miss the clip are
+ *        skipped; the clear always runs, since it fills exactly the clip.
+ */
+inline void RenderPlanReplay(RenderPlan& plan, RenderBackend& backend) {
+    backend.BeginFrame(plan.scene);
+    const RenderClip clip = backend.Clip();
+    for (const RenderOp& op : plan.ops) {
+        if (op.type != RENDER_OP_CLEAR &&
+            (op.right <= clip.left || op.left >= clip.right || op.bottom <= clip.top || op.top >= clip.bottom)) {
+            continue;
+        }
+        switch (op.type) {
+            case RENDER_OP_CLEAR:
+                backend.Clear(op.color);
+                break;
+            case RENDER_OP_BLEND_RECT:
+                backend.BlendRect(op.left, op.top, op.right, op.bottom, op.color);
+                break;
+            case RENDER_OP_GRID_LINES:
+                backend.DrawGridLines(plan.geometry, plan.scene.lineWidth, op.color);
+                break;
+            case RENDER_OP_LABEL:
+                backend.DrawLabel(op.text, op.left, op.top, op.right, op.bottom, op.color);
+                break;
+            case RENDER_OP_FILL_CIRCLE:
+                backend.FillCircle((op.left + op.right) / 2, (op.top + op.bottom) / 2, (op.right - op.left) / 2, op.color);
+                break;
+        }
+    }
+    backend.EndFrame();
+    ++plan.replays;
+}
+
+/**
+ * @brief Draws the scene through the plan, recompiling it first only if the scene changed.
+ */
+inline void RenderPlanDraw(RenderPlan& plan, RenderBackend& backend, const GridScene& scene) {
+    if (!RenderPlanMatches(plan, scene)) {
+        RenderPlanBuild(plan, scene);
+    }
+    RenderPlanReplay(plan, backend);
+}
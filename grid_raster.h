@@ -0,0 +1,563 @@
+/**
+ * @file grid_raster.h
+ * @brief A small, platform-independent software rasterizer for the grid overlay.
+ *
+ * Everything here writes into a caller-supplied 32-bit ARGB buffer (0xAARRGGBB,
+ * premultiplied alpha, top-down rows), which is the same layout as a top-down
+ * 32bpp Windows DIB section. There are no Windows dependencies, so the renderer
+ * can be built and profiled on any platform.
+ *
+ * Horizontal spans are filled and alpha-blended with SSE2 on x86-64 and with
+ * AVX2 when the CPU supports it (selected once at runtime on GCC/Clang builds).
+ * Every path produces bit-identical pixels.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+#include "grid_geometry.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GRID_RASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(GRID_RASTER_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define GRID_RASTER_AVX2 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief A view of an ARGB32 pixel buffer. The rasterizer never allocates or frees it.
+ *
+ * Every primitive is clipped to [clipLeft, clipRight) x [clipTop, clipBottom),
+ * which lets callers re-render just a dirty rectangle of a retained frame.
+ */
+struct RasterSurface {
+    uint32_t* pixels;
+    int width;
+    int height;
+    int stride; // Distance between rows, in pixels.
+    int clipLeft;
+    int clipTop;
+    int clipRight;
+    int clipBottom;
+};
+
+/**
+ * @brief Wraps a buffer in a surface whose clip covers the whole buffer.
+ */
+inline RasterSurface RasterMakeSurface(uint32_t* pixels, int width, int height, int stride) {
+    RasterSurface surface = { pixels, width, height, stride, 0, 0, width, height };
+    return surface;
+}
+
+/**
+ * @brief Narrows the surface's clip to the intersection with [left, right) x [top, bottom).
+ * @return false if the resulting clip is empty.
+ */
+inline bool RasterSetClip(RasterSurface& surface, int left, int top, int right, int bottom) {
+    surface.clipLeft = left > 0 ? left : 0;
+    surface.clipTop = top > 0 ? top : 0;
+    surface.clipRight = right < surface.width ? right : surface.width;
+    surface.clipBottom = bottom < surface.height ? bottom : surface.height;
+    return surface.clipLeft < surface.clipRight && surface.clipTop < surface.clipBottom;
+}
+
+/**
+ * @brief Packs a straight-alpha color into premultiplied 0xAARRGGBB.
+ */
+inline uint32_t RasterArgb(uint8_t a, uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)a << 24) |
+           ((uint32_t)(r * a / 255) << 16) |
+           ((uint32_t)(g * a / 255) << 8) |
+           (uint32_t)(b * a / 255);
+}
+
+//--------------------------------------------------------------------------------------
+// Span Fills
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief Portable span fill, also used for the unaligned head/tail of the SIMD paths.
+ */
+inline void RasterFillSpanScalar(uint32_t* dst, int count, uint32_t color) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+#if defined(GRID_RASTER_SSE2)
+inline void RasterFillSpanSse2(uint32_t* dst, int count, uint32_t color) {
+    // Align the destination so the main loop can use aligned stores.
+    while (count > 0 && ((uintptr_t)dst & 15) != 0) {
+        *dst++ = color;
+        --count;
+    }
+    const __m128i value = _mm_set1_epi32((int)color);
+    for (; count >= 16; count -= 16, dst += 16) {
+        _mm_store_si128((__m128i*)(dst + 0), value);
+        _mm_store_si128((__m128i*)(dst + 4), value);
+        _mm_store_si128((__m128i*)(dst + 8), value);
+        _mm_store_si128((__m128i*)(dst + 12), value);
+    }
+    for (; count >= 4; count -= 4, dst += 4) {
+        _mm_store_si128((__m128i*)dst, value);
+    }
+    RasterFillSpanScalar(dst, count, color);
+}
+#endif
+
+#if defined(GRID_RASTER_AVX2)
+__attribute__((target("avx2")))
+inline void RasterFillSpanAvx2(uint32_t* dst, int count, uint32_t color) {
+    while (count > 0 && ((uintptr_t)dst & 31) != 0) {
+        *dst++ = color;
+        --count;
+    }
+    const __m256i value = _mm256_set1_epi32((int)color);
+    for (; count >= 32; count -= 32, dst += 32) {
+        _mm256_store_si256((__m256i*)(dst + 0), value);
+        _mm256_store_si256((__m256i*)(dst + 8), value);
+        _mm256_store_si256((__m256i*)(dst + 16), value);
+        _mm256_store_si256((__m256i*)(dst + 24), value);
+    }
+    for (; count >= 8; count -= 8, dst += 8) {
+        _mm256_store_si256((__m256i*)dst, value);
+    }
+    RasterFillSpanScalar(dst, count, color);
+}
+#endif
+
+typedef void (*RasterSpanFillFn)(uint32_t* dst, int count, uint32_t color);
+
+/**
+ * @brief Picks the widest span fill the running CPU supports. Evaluated once.
+ */
+inline RasterSpanFillFn RasterSelectSpanFill() {
+#if defined(GRID_RASTER_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return RasterFillSpanAvx2;
+    }
+#endif
+#if defined(GRID_RASTER_SSE2)
+    return RasterFillSpanSse2;
+#else
+    return RasterFillSpanScalar;
+#endif
+}
+
+/**
+ * @brief Fills @p count pixels starting at @p dst with @p color.
+ */
+inline void RasterFillSpan(uint32_t* dst, int count, uint32_t color) {
+    static const RasterSpanFillFn fill = RasterSelectSpanFill();
+    if (count > 0) {
+        fill(dst, count, color);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Span Blends
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief x / 255, rounded, for x in [0, 255 * 255]. Matches the SIMD kernels exactly.
+ */
+inline uint32_t RasterDiv255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+/**
+ * @brief Composites a premultiplied color over a premultiplied pixel (source-over).
+ *
+ * Works on two channels at once in 16-bit fields of a 32-bit word; each field
+ * goes through the same rounding as RasterDiv255, so results match it exactly.
+ */
+inline uint32_t RasterBlendOver(uint32_t src, uint32_t dst) {
+    const uint32_t inv = 255 - (src >> 24);
+    uint32_t rb = (dst & 0x00FF00FF) * inv + 0x00800080;
+    uint32_t ag = ((dst >> 8) & 0x00FF00FF) * inv + 0x00800080;
+    rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    ag = (ag + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+    return src + (ag | rb);
+}
+
+/**
+ * @brief Portable span blend, also used for the tails of the SIMD paths.
+ */
+inline void RasterBlendSpanScalar(uint32_t* dst, int count, uint32_t color) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = RasterBlendOver(color, dst[i]);
+    }
+}
+
+#if defined(GRID_RASTER_SSE2)
+/**
+ * @brief Blends four pixels: channels are widened to 16 bits, scaled by the
+ *        inverse source alpha, divided by 255 with rounding, then the source added.
+ */
+inline __m128i RasterBlendOverSse2(__m128i dst, __m128i src, __m128i inv) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inv), bias);
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inv), bias);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    return _mm_add_epi8(_mm_packus_epi16(lo, hi), src);
+}
+
+inline void RasterBlendSpanSse2(uint32_t* dst, int count, uint32_t color) {
+    const __m128i src = _mm_set1_epi32((int)color);
+    const __m128i inv = _mm_set1_epi16((short)(255 - (color >> 24)));
+    for (; count >= 4; count -= 4, dst += 4) {
+        const __m128i d = _mm_loadu_si128((const __m128i*)dst);
+        _mm_storeu_si128((__m128i*)dst, RasterBlendOverSse2(d, src, inv));
+    }
+    RasterBlendSpanScalar(dst, count, color);
+}
+#endif
+
+#if defined(GRID_RASTER_AVX2)
+__attribute__((target("avx2")))
+inline void RasterBlendSpanAvx2(uint32_t* dst, int count, uint32_t color) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bias = _mm256_set1_epi16(128);
+    const __m256i src = _mm256_set1_epi32((int)color);
+    const __m256i inv = _mm256_set1_epi16((short)(255 - (color >> 24)));
+    // Unpack and pack both work within 128-bit lanes, so pixel order is preserved.
+    for (; count >= 8; count -= 8, dst += 8) {
+        const __m256i d = _mm256_loadu_si256((const __m256i*)dst);
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv), bias);
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv), bias);
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+        _mm256_storeu_si256((__m256i*)dst, _mm256_add_epi8(_mm256_packus_epi16(lo, hi), src));
+    }
+    RasterBlendSpanScalar(dst, count, color);
+}
+#endif
+
+/**
+ * @brief Picks the widest span blend the running CPU supports. Evaluated once.
+ */
+inline RasterSpanFillFn RasterSelectSpanBlend() {
+#if defined(GRID_RASTER_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return RasterBlendSpanAvx2;
+    }
+#endif
+#if defined(GRID_RASTER_SSE2)
+    return RasterBlendSpanSse2;
+#else
+    return RasterBlendSpanScalar;
+#endif
+}
+
+/**
+ * @brief Composites the premultiplied @p color over @p count pixels starting at @p dst.
+ */
+inline void RasterBlendSpan(uint32_t* dst, int count, uint32_t color) {
+    static const RasterSpanFillFn blend = RasterSelectSpanBlend();
+    if (count > 0) {
+        blend(dst, count, color);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Primitives
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief Fills the half-open rectangle [x0, x1) x [y0, y1), clipped to the surface.
+ */
+inline void RasterFillRect(RasterSurface& surface, int x0, int y0, int x1, int y1, uint32_t color) {
+    if (x0 < surface.clipLeft) x0 = surface.clipLeft;
+    if (y0 < surface.clipTop) y0 = surface.clipTop;
+    if (x1 > surface.clipRight) x1 = surface.clipRight;
+    if (y1 > surface.clipBottom) y1 = surface.clipBottom;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    uint32_t* row = surface.pixels + (intptr_t)y0 * surface.stride + x0;
+    if (surface.stride == surface.width && x0 == 0 && x1 == surface.width) {
+        // Contiguous rows collapse into a single span.
+        RasterFillSpan(row, (y1 - y0) * surface.width, color);
+        return;
+    }
+    for (int y = y0; y < y1; ++y, row += surface.stride) {
+        RasterFillSpan(row, x1 - x0, color);
+    }
+}
+
+/**
+ * @brief Fills the surface's clip rectangle with @p color.
+ */
+inline void RasterClear(RasterSurface& surface, uint32_t color) {
+    RasterFillRect(surface, surface.clipLeft, surface.clipTop, surface.clipRight, surface.clipBottom, color);
+}
+
+/**
+ * @brief Composites a translucent premultiplied color over [x0, x1) x [y0, y1),
+ *        clipped to the surface. Opaque colors take the plain fill path.
+ */
+inline void RasterBlendRect(RasterSurface& surface, int x0, int y0, int x1, int y1, uint32_t color) {
+    if ((color >> 24) == 255) {
+        RasterFillRect(surface, x0, y0, x1, y1, color);
+        return;
+    }
+    if ((color >> 24) == 0) {
+        return;
+    }
+    if (x0 < surface.clipLeft) x0 = surface.clipLeft;
+    if (y0 < surface.clipTop) y0 = surface.clipTop;
+    if (x1 > surface.clipRight) x1 = surface.clipRight;
+    if (y1 > surface.clipBottom) y1 = surface.clipBottom;
+
+    uint32_t* row = surface.pixels + (intptr_t)y0 * surface.stride + x0;
+    if (x1 - x0 < 4) {
+        // Narrow columns (anti-aliased line edges) are too short for the SIMD kernels to pay off.
+        for (int y = y0; y < y1; ++y, row += surface.stride) {
+            RasterBlendSpanScalar(row, x1 - x0, color);
+        }
+        return;
+    }
+    for (int y = y0; y < y1; ++y, row += surface.stride) {
+        RasterBlendSpan(row, x1 - x0, color);
+    }
+}
+
+/**
+ * @brief Draws a 1px horizontal line covering [x0, x1) on row @p y.
+ */
+inline void RasterHLine(RasterSurface& surface, int x0, int x1, int y, uint32_t color) {
+    RasterFillRect(surface, x0, y, x1, y + 1, color);
+}
+
+/**
+ * @brief Draws a 1px vertical line covering [y0, y1) in column @p x.
+ */
+inline void RasterVLine(RasterSurface& surface, int x, int y0, int y1, uint32_t color) {
+    if (x < surface.clipLeft || x >= surface.clipRight) {
+        return;
+    }
+    if (y0 < surface.clipTop) y0 = surface.clipTop;
+    if (y1 > surface.clipBottom) y1 = surface.clipBottom;
+    uint32_t* p = surface.pixels + (intptr_t)y0 * surface.stride + x;
+    for (int y = y0; y < y1; ++y, p += surface.stride) {
+        *p = color;
+    }
+}
+
+/**
+ * @brief Scales a premultiplied color by a coverage of 0-255.
+ */
+inline uint32_t RasterScaleColor(uint32_t color, uint32_t coverage) {
+    return (RasterDiv255((color >> 24) * coverage) << 24) |
+           (RasterDiv255(((color >> 16) & 0xFF) * coverage) << 16) |
+           (RasterDiv255(((color >> 8) & 0xFF) * coverage) << 8) |
+           RasterDiv255((color & 0xFF) * coverage);
+}
+
+/**
+ * @brief Composites @p color at a fractional coverage (0-1) over one pixel, if it lies in the clip.
+ */
+inline void RasterBlendPixel(RasterSurface& surface, int x, int y, uint32_t color, double coverage) {
+    if (x < surface.clipLeft || x >= surface.clipRight || y < surface.clipTop || y >= surface.clipBottom) {
+        return;
+    }
+    if (coverage <= 0.0) {
+        return;
+    }
+    const uint32_t cov = (uint32_t)(coverage * 255.0 + 0.5);
+    if (cov > 0) {
+        uint32_t& p = surface.pixels[(intptr_t)y * surface.stride + x];
+        p = RasterBlendOver(RasterScaleColor(color, cov), p);
+    }
+}
+
+/**
+ * @brief Fills the circle inscribed in [cx - r, cx + r) x [cy - r, cy + r), the same
+ *        box GDI's Ellipse uses. A pixel is inside when its center is. Translucent
+ *        colors are composited over the surface.
+ */
+inline void RasterFillCircle(RasterSurface& surface, int cx, int cy, int r, uint32_t color) {
+    if (r <= 0) {
+        return;
+    }
+    // Work in doubled coordinates so pixel centers (x + 0.5) stay integral.
+    const double r2 = 4.0 * r * r;
+    int yStart = cy - r < surface.clipTop ? surface.clipTop : cy - r;
+    int yEnd = cy + r > surface.clipBottom ? surface.clipBottom : cy + r;
+    for (int y = yStart; y < yEnd; ++y) {
+        const double dy = 2.0 * (y - cy) + 1.0;
+        const double remaining = r2 - dy * dy;
+        if (remaining < 0.0) {
+            continue;
+        }
+        const double h = sqrt(remaining);
+        // Solve |2x + 1 - 2cx| <= h for integer x.
+        const int x0 = (int)ceil((2.0 * cx - 1.0 - h) * 0.5);
+        const int x1 = (int)floor((2.0 * cx - 1.0 + h) * 0.5) + 1;
+        RasterBlendRect(surface, x0, y, x1, y + 1, color);
+    }
+}
+
+/**
+ * @brief Anti-aliased version of RasterFillCircle with the same center and radius.
+ *
+ * A pixel's coverage is r + 0.5 minus the distance from its center to the
+ * circle's, clamped to [0, 1]: the area of the pixel inside the edge, treating
+ * the edge as straight across it. Only the one or two edge pixels at each end
+ * of a row are computed individually; the fully covered run between them is
+ * handed to the SIMD span kernels.
+ */
+inline void RasterFillCircleAA(RasterSurface& surface, int cx, int cy, int r, uint32_t color) {
+    if (r <= 0) {
+        return;
+    }
+    const double outer = r + 0.5;
+    const double inner = r - 0.5;
+    int yStart = cy - r - 1 < surface.clipTop ? surface.clipTop : cy - r - 1;
+    int yEnd = cy + r + 1 > surface.clipBottom ? surface.clipBottom : cy + r + 1;
+    for (int y = yStart; y < yEnd; ++y) {
+        const double dy = y + 0.5 - cy;
+        const double outerRemaining = outer * outer - dy * dy;
+        if (outerRemaining <= 0.0) {
+            continue;
+        }
+        // Pixels whose centers lie within the outer and inner half-widths of this row.
+        const double ow = sqrt(outerRemaining);
+        const int x0 = (int)floor(cx - ow - 0.5);
+        const int x1 = (int)ceil(cx + ow - 0.5) + 1;
+        const double innerRemaining = inner * inner - dy * dy;
+        int full0 = x1, full1 = x1;
+        if (innerRemaining > 0.0) {
+            const double iw = sqrt(innerRemaining);
+            full0 = (int)ceil(cx - iw - 0.5);
+            full1 = (int)floor(cx + iw - 0.5) + 1;
+            if (full0 >= full1) {
+                full0 = full1 = x1;
+            }
+        }
+
+        for (int x = x0; x < full0; ++x) {
+            const double dx = x + 0.5 - cx;
+            const double coverage = outer - sqrt(dx * dx + dy * dy);
+            RasterBlendPixel(surface, x, y, color, coverage < 1.0 ? coverage : 1.0);
+        }
+        RasterBlendRect(surface, full0, y, full1, y + 1, color);
+        for (int x = full1; x < x1; ++x) {
+            const double dx = x + 0.5 - cx;
+            const double coverage = outer - sqrt(dx * dx + dy * dy);
+            RasterBlendPixel(surface, x, y, color, coverage < 1.0 ? coverage : 1.0);
+        }
+    }
+}
+
+/**
+ * @brief Draws full-height vertical grid lines covering [starts[i], starts[i] + lineWidth),
+ *        skipping those outside the clip. A fractional start gives the boundary
+ *        columns partial coverage instead of snapping the line to a pixel.
+ *
+ * Each line is only a few pixels wide, so the rows are walked once and every
+ * line's pixels written per row; a strided pass per line costs far more in
+ * cache and TLB misses at 4K.
+ */
+inline void RasterGridLinesV(RasterSurface& surface, const GridGeometry& geometry, const double* starts, int count,
+                             int lineWidth, uint32_t color) {
+    struct Column {
+        int x0, full0, full1, x1;
+        uint32_t leftColor, rightColor;
+    };
+    Column columns[GRID_MAX_CELLS];
+    int visible = 0;
+    for (int i = 0; i < count; ++i) {
+        const double left = starts[i];
+        const double right = left + lineWidth;
+        if (left >= surface.clipRight || right <= surface.clipLeft) {
+            continue;
+        }
+        Column& c = columns[visible++];
+        c.full0 = (int)ceil(left);
+        c.full1 = (int)floor(right);
+        c.leftColor = RasterScaleColor(color, (uint32_t)((c.full0 - left) * 255.0 + 0.5));
+        c.rightColor = RasterScaleColor(color, (uint32_t)((right - c.full1) * 255.0 + 0.5));
+        c.x0 = c.full0 - (c.leftColor ? 1 : 0);
+        c.x1 = c.full1 + (c.rightColor ? 1 : 0);
+        if (c.x0 < surface.clipLeft) c.x0 = surface.clipLeft;
+        if (c.x1 > surface.clipRight) c.x1 = surface.clipRight;
+    }
+    if (visible == 0) {
+        return;
+    }
+
+    const int y0 = surface.clipTop;
+    const int y1 = geometry.height < surface.clipBottom ? geometry.height : surface.clipBottom;
+    const bool opaque = (color >> 24) == 255;
+    uint32_t* row = surface.pixels + (intptr_t)y0 * surface.stride;
+    for (int y = y0; y < y1; ++y, row += surface.stride) {
+        for (int i = 0; i < visible; ++i) {
+            const Column& c = columns[i];
+            for (int x = c.x0; x < c.x1; ++x) {
+                if (x < c.full0) {
+                    row[x] = RasterBlendOver(c.leftColor, row[x]);
+                } else if (x >= c.full1) {
+                    row[x] = RasterBlendOver(c.rightColor, row[x]);
+                } else {
+                    row[x] = opaque ? color : RasterBlendOver(color, row[x]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Draws a full-width horizontal grid line covering [top, top + lineWidth),
+ *        if it reaches into the clip. Fractional positions are anti-aliased as in
+ *        RasterGridLinesV.
+ */
+inline void RasterGridLineH(RasterSurface& surface, const GridGeometry& geometry, double top, int lineWidth, uint32_t color) {
+    const double bottom = top + lineWidth;
+    if (top >= surface.clipBottom || bottom <= surface.clipTop) {
+        return;
+    }
+    const int full0 = (int)ceil(top);
+    const int full1 = (int)floor(bottom);
+    if (full0 > top) {
+        RasterBlendRect(surface, 0, full0 - 1, geometry.width, full0, RasterScaleColor(color, (uint32_t)((full0 - top) * 255.0 + 0.5)));
+    }
+    RasterBlendRect(surface, 0, full0, geometry.width, full1, color);
+    if (bottom > full1) {
+        RasterBlendRect(surface, 0, full1, geometry.width, full1 + 1, RasterScaleColor(color, (uint32_t)((bottom - full1) * 255.0 + 0.5)));
+    }
+}
+
+/**
+ * @brief Where the line for edge @p i starts. Crisp lines sit on the integer edge;
+ *        anti-aliased ones on the exact i * size / count, so spacing stays even.
+ */
+inline double RasterGridLineStart(const int* edges, int i, int size, int count, int lineWidth, bool antialias) {
+    const double edge = antialias ? (double)i * size / count : edges[i];
+    return edge - (lineWidth - 1) / 2;
+}
+
+/**
+ * @brief Draws the interior grid lines at the geometry's edges, @p lineWidth pixels
+ *        thick. Lines outside the clip are skipped.
+ * @param antialias Place lines at their exact fractional positions with partial
+ *        coverage, rather than snapping them to the integer edges.
+ */
+inline void RasterDrawGridLines(RasterSurface& surface, const GridGeometry& geometry, int lineWidth, uint32_t color, bool antialias) {
+    double starts[GRID_MAX_CELLS];
+    for (int i = 1; i < geometry.cols; ++i) {
+        starts[i - 1] = RasterGridLineStart(geometry.colEdge, i, geometry.width, geometry.cols, lineWidth, antialias);
+    }
+    RasterGridLinesV(surface, geometry, starts, geometry.cols - 1, lineWidth, color);
+    for (int i = 1; i < geometry.rows; ++i) {
+        RasterGridLineH(surface, geometry, RasterGridLineStart(geometry.rowEdge, i, geometry.height, geometry.rows, lineWidth, antialias), lineWidth, color);
+    }
+}
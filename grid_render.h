@@ -0,0 +1,215 @@
+/**
+ * @file grid_render.h
+ * @brief Renders a complete overlay frame from a plain description of the scene.
+ *
+ * The scene holds everything a frame depends on, so a frame can be produced
+ * without a window. Frames are drawn as a handful of primitive operations
+ * against a RenderBackend (see grid_plan.h for how they are issued); the
+ * software rasterizer and headless memory backends live here, and
+ * grid_render_gdi.h adds a GDI one on Windows. Because all backends see the
+ * same operation stream, they can be compared directly, and a headless frame
+ * can be dumped to a PPM or PAM file for inspection or comparison.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "grid_geometry.h"
+#include "grid_raster.h"
+#include "grid_glyphs.h"
+#include "grid_cells.h"
+
+/**
+ * @brief Inputs for one frame. Colors are premultiplied 0xAARRGGBB.
+ */
+struct GridScene {
+    const GridGeometry* geometry;
+    const GlyphAtlas* labelAtlas; // Digit atlas for raster backends; NULL omits their labels.
+    GlyphStrip* labelStrip;       // The atlas's strip cache, resampled by raster backends as the height changes.
+    int labelFontHeight;          // Label height in pixels; the atlas is scaled to it.
+    const CellStates* cells;      // Progress marks; NULL or none marked skips the cell pass.
+    uint32_t cellColors[CELL_STATE_COUNT]; // Fill per state, or outline color when !translucent; CELL_EMPTY's is unused.
+    int cellOutlineWidth;         // Thickness of cell-mark outlines.
+    int blinkCell;                // Cell index lit by the blink cue this frame; -1 for none.
+    uint32_t blinkColor;
+    int hoverCol;                 // Highlighted column and row; -1 for none.
+    int hoverRow;
+    uint32_t hoverColor;
+    bool dotSet;
+    int dotX;
+    int dotY;
+    int dotRadius;
+    int dotHaloRadius;            // Translucent ring under the dot, drawn only when translucent; 0 for none.
+    uint32_t dotHaloColor;
+    int lineWidth;
+    bool antialias;               // Anti-alias lines, circles and labels in raster backends.
+    bool translucent;             // Translucent colors reach the screen. Under a color key they would
+                                  // come out opaque, so marks are drawn as outlines instead of fills.
+    uint32_t background;
+    uint32_t gridColor;
+    uint32_t labelColor;
+    uint32_t dotColor;
+};
+
+/**
+ * @brief A clip rectangle, [left, right) x [top, bottom).
+ */
+struct RenderClip {
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+/**
+ * @brief The primitive operations a frame is made of.
+ *
+ * A frame is BeginFrame, any number of drawing calls, then EndFrame. Drawing
+ * is clipped to Clip(), which callers may also use to skip work up front.
+ */
+class RenderBackend {
+public:
+    virtual ~RenderBackend() {}
+
+    // Prepares per-frame resources (fonts, atlases) for the scene.
+    virtual void BeginFrame(const GridScene& scene) = 0;
+    virtual RenderClip Clip() const = 0;
+    virtual void Clear(uint32_t color) = 0;
+    // Composites a translucent color over [left, right) x [top, bottom).
+    virtual void BlendRect(int left, int top, int right, int bottom, uint32_t color) = 0;
+    // Interior grid lines at the geometry's edges, lineWidth pixels thick.
+    virtual void DrawGridLines(const GridGeometry& geometry, int lineWidth, uint32_t color) = 0;
+    // ASCII digits centered in [left, right) x [top, bottom).
+    virtual void DrawLabel(const char* text, int left, int top, int right, int bottom, uint32_t color) = 0;
+    // Circle inscribed in [cx - r, cx + r) x [cy - r, cy + r).
+    virtual void FillCircle(int cx, int cy, int r, uint32_t color) = 0;
+    // Finishes the frame; backends that present immediately do so here.
+    virtual void EndFrame() = 0;
+};
+
+/**
+ * @brief Software backend drawing into a caller-owned RasterSurface, honouring its clip.
+ */
+class RasterBackend : public RenderBackend {
+public:
+    explicit RasterBackend(const RasterSurface& surface)
+        : m_surface(surface), m_atlas(NULL), m_strip(NULL), m_fontHeight(0), m_antialias(false) {}
+
+    void BeginFrame(const GridScene& scene) override {
+        m_atlas = scene.labelAtlas;
+        m_strip = scene.labelStrip;
+        m_fontHeight = scene.labelFontHeight;
+        m_antialias = scene.antialias;
+    }
+    RenderClip Clip() const override {
+        RenderClip clip = { m_surface.clipLeft, m_surface.clipTop, m_surface.clipRight, m_surface.clipBottom };
+        return clip;
+    }
+    void Clear(uint32_t color) override {
+        RasterClear(m_surface, color);
+    }
+    void BlendRect(int left, int top, int right, int bottom, uint32_t color) override {
+        RasterBlendRect(m_surface, left, top, right, bottom, color);
+    }
+    void DrawGridLines(const GridGeometry& geometry, int lineWidth, uint32_t color) override {
+        RasterDrawGridLines(m_surface, geometry, lineWidth, color, m_antialias);
+    }
+    void DrawLabel(const char* text, int left, int top, int right, int bottom, uint32_t color) override {
+        if (m_atlas && m_strip) {
+            RasterDrawGlyphTextCentered(m_surface, *m_atlas, *m_strip, text, m_fontHeight, left, top, right, bottom, color,
+                                        m_antialias);
+        }
+    }
+    void FillCircle(int cx, int cy, int r, uint32_t color) override {
+        if (m_antialias) {
+            RasterFillCircleAA(m_surface, cx, cy, r, color);
+        } else {
+            RasterFillCircle(m_surface, cx, cy, r, color);
+        }
+    }
+    void EndFrame() override {}
+
+    const RasterSurface& Surface() const { return m_surface; }
+
+protected:
+    RasterSurface m_surface;
+    const GlyphAtlas* m_atlas;
+    GlyphStrip* m_strip;
+    int m_fontHeight;
+    bool m_antialias;
+};
+
+/**
+ * @brief Headless backend that owns its pixels and sizes them to each scene.
+ *        Allocates only when the scene size changes.
+ */
+class MemoryBackend : public RasterBackend {
+public:
+    MemoryBackend() : RasterBackend(RasterMakeSurface(NULL, 0, 0, 0)) {}
+
+    void BeginFrame(const GridScene& scene) override {
+        const int width = scene.geometry->width;
+        const int height = scene.geometry->height;
+        if (width != m_surface.width || height != m_surface.height) {
+            m_pixels.assign((size_t)width * height, 0);
+            m_surface = RasterMakeSurface(m_pixels.data(), width, height, width);
+        }
+        RasterBackend::BeginFrame(scene);
+    }
+
+private:
+    std::vector<uint32_t> m_pixels;
+};
+
+/**
+ * @brief Writes the surface as a binary PPM. Premultiplied colors come out as if
+ *        composited over black.
+ * @return false if the file could not be written.
+ */
+inline bool RasterWritePpm(const RasterSurface& surface, FILE* file) {
+    if (fprintf(file, "P6\n%d %d\n255\n", surface.width, surface.height) < 0) {
+        return false;
+    }
+    for (int y = 0; y < surface.height; ++y) {
+        const uint32_t* row = surface.pixels + (intptr_t)y * surface.stride;
+        for (int x = 0; x < surface.width; ++x) {
+            const unsigned char rgb[3] = {
+                (unsigned char)(row[x] >> 16), (unsigned char)(row[x] >> 8), (unsigned char)row[x]
+            };
+            if (fwrite(rgb, 1, 3, file) != 3) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the surface as a binary PAM with an alpha channel, so translucent
+ *        pixels keep their coverage. PAM stores straight alpha, so colors are
+ *        un-premultiplied; fully transparent pixels come out as zero.
+ * @return false if the file could not be written.
+ */
+inline bool RasterWritePam(const RasterSurface& surface, FILE* file) {
+    if (fprintf(file, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n",
+                surface.width, surface.height) < 0) {
+        return false;
+    }
+    for (int y = 0; y < surface.height; ++y) {
+        const uint32_t* row = surface.pixels + (intptr_t)y * surface.stride;
+        for (int x = 0; x < surface.width; ++x) {
+            const uint32_t a = row[x] >> 24;
+            unsigned char rgba[4] = { 0, 0, 0, (unsigned char)a };
+            for (int ch = 0; a != 0 && ch < 3; ++ch) {
+                const uint32_t c = ((row[x] >> (16 - 8 * ch)) & 0xFF) * 255 + a / 2;
+                rgba[ch] = (unsigned char)(c / a > 255 ? 255 : c / a);
+            }
+            if (fwrite(rgba, 1, 4, file) != 4) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file grid_render_gdi.h
+ * @brief The GDI render backend. Windows only.
+ *
+ * Kept apart from grid_render.h so the portable backends build anywhere,
+ * while the overlay and the benchmarks share this one.
+ */
+
+#pragma once
+
+#include <windows.h>
+#include <stdint.h>
+#include "grid_geometry.h"
+#include "grid_raster.h"
+#include "grid_render.h"
+
+/**
+ * @brief Returns the label font for a pixel height. The font stays owned by the caller.
+ */
+typedef HFONT (*GdiLabelFontFn)(int fontHeight);
+
+/**
+ * @brief Converts an opaque 0xAARRGGBB color back to a COLORREF.
+ */
+inline COLORREF ArgbToColorRef(uint32_t color) {
+    return RGB((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+}
+
+/**
+ * @brief Backend drawing straight onto a device context with GDI, matching the
+ *        original renderer. The overlay paints through it when no back buffer can
+ *        be allocated; the benchmarks time it against the raster backends.
+ *
+ * Fills use the stock DC brush and the dot the stock null pen, so no GDI
+ * objects are created per frame. Lines use the caller's pen, which already
+ * has the grid color and width, and labels the caller's cached fonts.
+ */
+class GdiBackend : public RenderBackend {
+public:
+    GdiBackend(HDC hdc, const RECT& clip, HPEN gridPen, GdiLabelFontFn labelFont)
+        : m_hdc(hdc), m_clip(clip), m_gridPen(gridPen), m_labelFont(labelFont), m_fontHeight(0), m_background(0) {}
+
+    void BeginFrame(const GridScene& scene) override {
+        m_fontHeight = scene.labelFontHeight;
+        m_background = scene.background;
+    }
+    RenderClip Clip() const override {
+        RenderClip clip = { (int)m_clip.left, (int)m_clip.top, (int)m_clip.right, (int)m_clip.bottom };
+        return clip;
+    }
+    void Clear(uint32_t color) override {
+        SetDCBrushColor(m_hdc, ArgbToColorRef(color));
+        FillRect(m_hdc, &m_clip, (HBRUSH)GetStockObject(DC_BRUSH));
+    }
+    void BlendRect(int left, int top, int right, int bottom, uint32_t color) override {
+        // GDI brushes are opaque, so pre-blend against the background this frame was cleared to.
+        // Opaque colors pass through RasterBlendOver unchanged.
+        RECT rect = { left, top, right, bottom };
+        SetDCBrushColor(m_hdc, ArgbToColorRef(RasterBlendOver(color, m_background)));
+        FillRect(m_hdc, &rect, (HBRUSH)GetStockObject(DC_BRUSH));
+    }
+    void DrawGridLines(const GridGeometry& geometry, int lineWidth, uint32_t color) override {
+        // The pen already has the grid color and width.
+        (void)lineWidth;
+        (void)color;
+        HPEN hOldPen = (HPEN)SelectObject(m_hdc, m_gridPen);
+        for (int i = 1; i < geometry.cols; ++i) {
+            int x = geometry.colEdge[i];
+            if (x < m_clip.left || x >= m_clip.right) continue;
+            MoveToEx(m_hdc, x, 0, NULL);
+            LineTo(m_hdc, x, geometry.height);
+        }
+        for (int i = 1; i < geometry.rows; ++i) {
+            int y = geometry.rowEdge[i];
+            if (y < m_clip.top || y >= m_clip.bottom) continue;
+            MoveToEx(m_hdc, 0, y, NULL);
+            LineTo(m_hdc, geometry.width, y);
+        }
+        SelectObject(m_hdc, hOldPen);
+    }
+    void DrawLabel(const char* text, int left, int top, int right, int bottom, uint32_t color) override {
+        wchar_t wideText[8];
+        int length = 0;
+        for (; text[length] && length < 7; ++length) {
+            wideText[length] = (wchar_t)text[length];
+        }
+        wideText[length] = L'\0';
+
+        HFONT hOldFont = (HFONT)SelectObject(m_hdc, m_labelFont(m_fontHeight));
+        SetTextColor(m_hdc, ArgbToColorRef(color));
+        SetBkMode(m_hdc, TRANSPARENT);
+        RECT cellRect = { left, top, right, bottom };
+        DrawTextW(m_hdc, wideText, length, &cellRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        SelectObject(m_hdc, hOldFont);
+    }
+    void FillCircle(int cx, int cy, int r, uint32_t color) override {
+        SetDCBrushColor(m_hdc, ArgbToColorRef(RasterBlendOver(color, m_background)));
+        HBRUSH hOldBrush = (HBRUSH)SelectObject(m_hdc, GetStockObject(DC_BRUSH));
+        HPEN hOldPen = (HPEN)SelectObject(m_hdc, GetStockObject(NULL_PEN)); // No border for the dot
+        Ellipse(m_hdc, cx - r, cy - r, cx + r, cy + r);
+        SelectObject(m_hdc, hOldBrush);
+        SelectObject(m_hdc, hOldPen);
+    }
+    void EndFrame() override {}
+
+private:
+    HDC m_hdc;
+    RECT m_clip;
+    HPEN m_gridPen;
+    GdiLabelFontFn m_labelFont;
+    int m_fontHeight;
+    uint32_t m_background;
+};
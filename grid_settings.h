@@ -0,0 +1,486 @@
+/**
+ * @file grid_settings.h
+ * @brief The overlay's saved settings, a versioned binary encoding of them, and
+ *        the stores that hold the encoded bytes.
+ *
+ * An encoded file is a 12-byte header followed by tagged records:
+ *
+ *     "GOSF" | u16 version | u16 reserved | u32 CRC-32 of the records
+ *     u16 tag | u16 length | length bytes ...
+ *
+ * A profile record nests the same layout records inside its payload.
+ *
+ * All integers are little-endian. Readers skip tags they don't know and ignore
+ * trailing bytes of records they do, so a newer version may add records or
+ * extend existing ones without breaking older readers; top-level records an
+ * older reader doesn't understand are kept and written back unchanged. Records
+ * missing from an older file keep their defaults. A bad magic or checksum
+ * rejects the whole file. No Windows dependencies.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include "grid_geometry.h"
+#include "grid_cells.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+const uint16_t SETTINGS_VERSION = 3;
+const int SETTINGS_HEADER_SIZE = 12;
+const size_t SETTINGS_MAX_SIZE = 64 * 1024; // Larger files are rejected as corrupt.
+const int SETTINGS_MAX_PROFILES = 9;
+const size_t SETTINGS_MAX_PROFILE_NAME = 63; // Bytes of UTF-8.
+
+enum SettingsTag {
+    // Layout records. At the top level they describe the active profile.
+    SETTINGS_TAG_WINDOW = 1, // i32 left, top, right, bottom (screen pixels).
+    SETTINGS_TAG_DOT = 2,    // u8 set, i32 x, i32 y (client pixels). Superseded by DOT_GRID.
+    SETTINGS_TAG_GRID = 3,   // u16 cols, u16 rows.
+    SETTINGS_TAG_CELLS = 5,  // CellStatesSave bytes for cols * rows cells.
+    SETTINGS_TAG_DOT_GRID = 8, // u8 set, i32 col, i32 row (grid space, 16.16 fixed point). (v3)
+
+    SETTINGS_TAG_FLAGS = 4,          // u32, SETTINGS_FLAG_* bits.
+    SETTINGS_TAG_PROFILE = 6,        // u8 name length, UTF-8 name, then layout records. One per profile. (v2)
+    SETTINGS_TAG_ACTIVE_PROFILE = 7, // u16 index into the profile records. (v2)
+};
+
+enum SettingsFlag {
+    SETTINGS_FLAG_FOLLOW_GAME = 1,
+    SETTINGS_FLAG_AUTO_HIDE = 2,
+};
+
+/**
+ * @brief One named overlay layout: where the grid sits, its size, marker and cell marks.
+ */
+struct LayoutProfile {
+    std::string name = "Default"; // UTF-8, at most SETTINGS_MAX_PROFILE_NAME bytes.
+    int windowLeft = 100;
+    int windowTop = 100;
+    int windowRight = 900;
+    int windowBottom = 600;
+    bool dotSet = false;
+    GridPoint dot;                // Grid space, so it survives resizing.
+    int cols = 10;
+    int rows = 6;
+    CellStates cells;
+};
+
+/**
+ * @brief Everything that is saved between runs. Defaults are used for anything
+ *        a file doesn't contain.
+ */
+struct OverlaySettings {
+    std::vector<LayoutProfile> profiles = std::vector<LayoutProfile>(1); // Never empty.
+    int activeProfile = 0;
+    bool followGame = false;
+    bool autoHide = false;
+    uint16_t version = SETTINGS_VERSION;  // Version the settings were read from; 0 for legacy values.
+    std::vector<uint8_t> unknownRecords;  // Encoded top-level records from a newer version.
+};
+
+/**
+ * @brief CRC-32 (IEEE) of @p size bytes. Bitwise; settings are only a few hundred bytes.
+ */
+inline uint32_t SettingsCrc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+inline void SettingsPutU16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back((uint8_t)value);
+    out.push_back((uint8_t)(value >> 8));
+}
+
+inline void SettingsPutU32(std::vector<uint8_t>& out, uint32_t value) {
+    SettingsPutU16(out, value & 0xFFFF);
+    SettingsPutU16(out, value >> 16);
+}
+
+inline uint32_t SettingsGetU16(const uint8_t* p) {
+    return p[0] | ((uint32_t)p[1] << 8);
+}
+
+inline uint32_t SettingsGetU32(const uint8_t* p) {
+    return SettingsGetU16(p) | (SettingsGetU16(p + 2) << 16);
+}
+
+/**
+ * @brief Starts a record; returns the offset of its length field for SettingsEndRecord.
+ */
+inline size_t SettingsBeginRecord(std::vector<uint8_t>& out, SettingsTag tag) {
+    SettingsPutU16(out, tag);
+    SettingsPutU16(out, 0);
+    return out.size() - 2;
+}
+
+inline void SettingsEndRecord(std::vector<uint8_t>& out, size_t lengthOffset) {
+    const size_t length = out.size() - lengthOffset - 2;
+    out[lengthOffset] = (uint8_t)length;
+    out[lengthOffset + 1] = (uint8_t)(length >> 8);
+}
+
+/**
+ * @brief Steps through the records in [data, data + size).
+ * @return false at the end, or if a record runs past it (@p truncated is then set).
+ */
+inline bool SettingsNextRecord(const uint8_t* data, size_t size, size_t& offset, uint32_t& tag,
+                               const uint8_t*& payload, size_t& length, bool& truncated) {
+    if (offset + 4 > size) {
+        return false;
+    }
+    tag = SettingsGetU16(data + offset);
+    length = SettingsGetU16(data + offset + 2);
+    payload = data + offset + 4;
+    if (offset + 4 + length > size) {
+        truncated = true;
+        return false;
+    }
+    offset += 4 + length;
+    return true;
+}
+
+/**
+ * @brief Builds the geometry of a layout's grid. The overlay has no border when
+ *        locked, so its client area is its window rectangle.
+ */
+inline GridGeometry SettingsLayoutGeometry(const LayoutProfile& layout) {
+    GridGeometry geometry;
+    GridGeometryUpdate(geometry, layout.windowRight - layout.windowLeft, layout.windowBottom - layout.windowTop,
+                       layout.cols, layout.rows);
+    return geometry;
+}
+
+/**
+ * @brief Appends the window, dot, grid and cell records for @p layout. The dot
+ *        is also written in client pixels for readers older than version 3.
+ */
+inline void SettingsEncodeLayout(const LayoutProfile& layout, std::vector<uint8_t>& out) {
+    size_t record = SettingsBeginRecord(out, SETTINGS_TAG_WINDOW);
+    SettingsPutU32(out, (uint32_t)layout.windowLeft);
+    SettingsPutU32(out, (uint32_t)layout.windowTop);
+    SettingsPutU32(out, (uint32_t)layout.windowRight);
+    SettingsPutU32(out, (uint32_t)layout.windowBottom);
+    SettingsEndRecord(out, record);
+
+    int dotX, dotY;
+    GridPointToClient(SettingsLayoutGeometry(layout), layout.dot, &dotX, &dotY);
+    record = SettingsBeginRecord(out, SETTINGS_TAG_DOT);
+    out.push_back(layout.dotSet ? 1 : 0);
+    SettingsPutU32(out, (uint32_t)dotX);
+    SettingsPutU32(out, (uint32_t)dotY);
+    SettingsEndRecord(out, record);
+
+    record = SettingsBeginRecord(out, SETTINGS_TAG_DOT_GRID);
+    out.push_back(layout.dotSet ? 1 : 0);
+    SettingsPutU32(out, (uint32_t)(int32_t)floor(layout.dot.col * 65536.0 + 0.5));
+    SettingsPutU32(out, (uint32_t)(int32_t)floor(layout.dot.row * 65536.0 + 0.5));
+    SettingsEndRecord(out, record);
+
+    record = SettingsBeginRecord(out, SETTINGS_TAG_GRID);
+    SettingsPutU16(out, (uint32_t)layout.cols);
+    SettingsPutU16(out, (uint32_t)layout.rows);
+    SettingsEndRecord(out, record);
+
+    const int cellCount = layout.cols * layout.rows;
+    if (layout.cells.marked > 0 && cellCount > 0 && cellCount <= CELL_MAX_COUNT) {
+        record = SettingsBeginRecord(out, SETTINGS_TAG_CELLS);
+        const size_t offset = out.size();
+        out.resize(offset + CellStatesByteCount(cellCount));
+        CellStatesSave(layout.cells, cellCount, &out[offset]);
+        SettingsEndRecord(out, record);
+    }
+}
+
+/**
+ * @brief Reads the layout records among [data, data + size) into @p layout and
+ *        skips any others. Fields without a valid record are left as they are.
+ * @return false if a record is truncated.
+ */
+inline bool SettingsDecodeLayout(const uint8_t* data, size_t size, LayoutProfile& layout) {
+    const uint8_t* pixelDot = NULL;
+    bool gridDot = false;
+    const uint8_t* cells = NULL;
+    size_t cellsLength = 0;
+    size_t offset = 0;
+    uint32_t tag;
+    const uint8_t* p;
+    size_t length;
+    bool truncated = false;
+    while (SettingsNextRecord(data, size, offset, tag, p, length, truncated)) {
+        switch (tag) {
+            case SETTINGS_TAG_WINDOW:
+                if (length >= 16 && (int32_t)SettingsGetU32(p + 8) > (int32_t)SettingsGetU32(p) &&
+                    (int32_t)SettingsGetU32(p + 12) > (int32_t)SettingsGetU32(p + 4)) {
+                    layout.windowLeft = (int32_t)SettingsGetU32(p);
+                    layout.windowTop = (int32_t)SettingsGetU32(p + 4);
+                    layout.windowRight = (int32_t)SettingsGetU32(p + 8);
+                    layout.windowBottom = (int32_t)SettingsGetU32(p + 12);
+                }
+                break;
+            case SETTINGS_TAG_DOT:
+                if (length >= 9) {
+                    pixelDot = p; // Only used without a DOT_GRID record, once the window and grid are known.
+                }
+                break;
+            case SETTINGS_TAG_DOT_GRID:
+                if (length >= 9) {
+                    gridDot = true;
+                    layout.dotSet = p[0] != 0;
+                    layout.dot.col = (int32_t)SettingsGetU32(p + 1) / 65536.0;
+                    layout.dot.row = (int32_t)SettingsGetU32(p + 5) / 65536.0;
+                }
+                break;
+            case SETTINGS_TAG_GRID:
+                if (length >= 4) {
+                    const int cols = (int)SettingsGetU16(p), rows = (int)SettingsGetU16(p + 2);
+                    if (cols > 0 && rows > 0 && cols <= GRID_MAX_CELLS && rows <= GRID_MAX_CELLS) {
+                        layout.cols = cols;
+                        layout.rows = rows;
+                    }
+                }
+                break;
+            case SETTINGS_TAG_CELLS:
+                cells = p; // Checked against the grid size once every record has been read.
+                cellsLength = length;
+                break;
+        }
+    }
+
+    if (pixelDot && !gridDot) {
+        layout.dotSet = pixelDot[0] != 0;
+        layout.dot = GridPointFromClient(SettingsLayoutGeometry(layout), (int32_t)SettingsGetU32(pixelDot + 1),
+                                         (int32_t)SettingsGetU32(pixelDot + 5));
+    }
+
+    // Marks are only meaningful for the grid size they were saved with.
+    CellStatesClear(layout.cells);
+    const int cellCount = layout.cols * layout.rows;
+    if (cells && cellsLength == (size_t)CellStatesByteCount(cellCount)) {
+        CellStatesLoad(layout.cells, cellCount, cells);
+    }
+    return !truncated;
+}
+
+/**
+ * @brief Encodes @p settings at SETTINGS_VERSION into @p out, replacing its contents.
+ *
+ * The active profile's layout is also written as top-level records, which is
+ * all that version 1 readers look at.
+ */
+inline void SettingsEncode(const OverlaySettings& settings, std::vector<uint8_t>& out) {
+    out.clear();
+    out.insert(out.end(), { 'G', 'O', 'S', 'F' });
+    SettingsPutU16(out, SETTINGS_VERSION);
+    SettingsPutU16(out, 0);
+    SettingsPutU32(out, 0); // Checksum, filled in last.
+
+    SettingsEncodeLayout(settings.profiles[settings.activeProfile], out);
+
+    size_t record = SettingsBeginRecord(out, SETTINGS_TAG_FLAGS);
+    SettingsPutU32(out, (settings.followGame ? SETTINGS_FLAG_FOLLOW_GAME : 0) |
+                        (settings.autoHide ? SETTINGS_FLAG_AUTO_HIDE : 0));
+    SettingsEndRecord(out, record);
+
+    for (const LayoutProfile& profile : settings.profiles) {
+        record = SettingsBeginRecord(out, SETTINGS_TAG_PROFILE);
+        const size_t nameLength = profile.name.size() < SETTINGS_MAX_PROFILE_NAME ? profile.name.size() : SETTINGS_MAX_PROFILE_NAME;
+        out.push_back((uint8_t)nameLength);
+        out.insert(out.end(), profile.name.begin(), profile.name.begin() + nameLength);
+        SettingsEncodeLayout(profile, out);
+        SettingsEndRecord(out, record);
+    }
+    record = SettingsBeginRecord(out, SETTINGS_TAG_ACTIVE_PROFILE);
+    SettingsPutU16(out, (uint32_t)settings.activeProfile);
+    SettingsEndRecord(out, record);
+
+    out.insert(out.end(), settings.unknownRecords.begin(), settings.unknownRecords.end());
+
+    const uint32_t crc = SettingsCrc32(&out[SETTINGS_HEADER_SIZE], out.size() - SETTINGS_HEADER_SIZE);
+    for (int i = 0; i < 4; ++i) {
+        out[8 + i] = (uint8_t)(crc >> (8 * i));
+    }
+}
+
+/**
+ * @brief Decodes bytes written by SettingsEncode of any version into @p settings.
+ *        Fields without a valid record keep the values @p settings already has.
+ *
+ * A version 1 file has no profile records and becomes a single profile. If
+ * the top-level layout disagrees with the active profile's record (an older
+ * version saved over a newer file), the top-level one wins.
+ * @return false if the bytes are not a settings file or fail the checksum;
+ *         @p settings is left unchanged.
+ */
+inline bool SettingsDecode(const uint8_t* data, size_t size, OverlaySettings& settings) {
+    if (size < (size_t)SETTINGS_HEADER_SIZE || size > SETTINGS_MAX_SIZE || memcmp(data, "GOSF", 4) != 0 ||
+        SettingsGetU32(data + 8) != SettingsCrc32(data + SETTINGS_HEADER_SIZE, size - SETTINGS_HEADER_SIZE)) {
+        return false;
+    }
+    const uint8_t* records = data + SETTINGS_HEADER_SIZE;
+    const size_t recordsSize = size - SETTINGS_HEADER_SIZE;
+
+    OverlaySettings decoded = settings;
+    decoded.version = (uint16_t)SettingsGetU16(data + 4);
+    decoded.unknownRecords.clear();
+    LayoutProfile active = settings.profiles[settings.activeProfile];
+    if (!SettingsDecodeLayout(records, recordsSize, active)) {
+        return false;
+    }
+
+    std::vector<LayoutProfile> profiles;
+    int activeProfile = 0;
+    size_t offset = 0;
+    uint32_t tag;
+    const uint8_t* p;
+    size_t length;
+    bool truncated = false;
+    while (SettingsNextRecord(records, recordsSize, offset, tag, p, length, truncated)) {
+        switch (tag) {
+            case SETTINGS_TAG_WINDOW:
+            case SETTINGS_TAG_DOT:
+            case SETTINGS_TAG_GRID:
+            case SETTINGS_TAG_CELLS:
+            case SETTINGS_TAG_DOT_GRID:
+                break; // Read by SettingsDecodeLayout above.
+            case SETTINGS_TAG_FLAGS:
+                if (length >= 4) {
+                    const uint32_t flags = SettingsGetU32(p);
+                    decoded.followGame = (flags & SETTINGS_FLAG_FOLLOW_GAME) != 0;
+                    decoded.autoHide = (flags & SETTINGS_FLAG_AUTO_HIDE) != 0;
+                }
+                break;
+            case SETTINGS_TAG_PROFILE:
+                if (length >= 1 && 1 + (size_t)p[0] <= length && (int)profiles.size() < SETTINGS_MAX_PROFILES) {
+                    LayoutProfile profile;
+                    profile.name.assign((const char*)p + 1, p[0]);
+                    if (SettingsDecodeLayout(p + 1 + p[0], length - 1 - p[0], profile)) {
+                        profiles.push_back(profile);
+                    }
+                }
+                break;
+            case SETTINGS_TAG_ACTIVE_PROFILE:
+                if (length >= 2) {
+                    activeProfile = (int)SettingsGetU16(p);
+                }
+                break;
+            default:
+                decoded.unknownRecords.insert(decoded.unknownRecords.end(), p - 4, p + length);
+                break;
+        }
+    }
+
+    if (profiles.empty()) {
+        profiles.push_back(active);
+        activeProfile = 0;
+    } else {
+        if (activeProfile >= (int)profiles.size()) {
+            activeProfile = 0;
+        }
+        active.name = profiles[activeProfile].name;
+        profiles[activeProfile] = active;
+    }
+    decoded.profiles.swap(profiles);
+    decoded.activeProfile = activeProfile;
+
+    settings = decoded;
+    return true;
+}
+
+/**
+ * @brief Somewhere to keep the encoded settings.
+ *
+ * Write must be atomic: after a crash, Read returns either the old bytes or
+ * the new ones, never a mixture.
+ */
+class SettingsStore {
+public:
+    virtual ~SettingsStore() {}
+
+    // Replaces @p bytes with the stored settings; false if there are none or they can't be read.
+    virtual bool Read(std::vector<uint8_t>& bytes) = 0;
+    virtual bool Write(const std::vector<uint8_t>& bytes) = 0;
+};
+
+/**
+ * @brief Keeps the settings in a file, replaced atomically by writing a sibling
+ *        temporary file, flushing it to disk and renaming it over the original.
+ *
+ * File access goes through the protected hooks so a platform can substitute
+ * its own: the defaults use stdio and rename(), which replaces the target
+ * atomically on POSIX systems. Paths are UTF-8.
+ */
+class FileSettingsStore : public SettingsStore {
+public:
+    explicit FileSettingsStore(const std::string& path) : m_path(path) {}
+
+    bool Read(std::vector<uint8_t>& bytes) override {
+        FILE* file = OpenPath(m_path.c_str(), false);
+        if (!file) {
+            return false;
+        }
+        bytes.clear();
+        uint8_t buffer[4096];
+        size_t count;
+        while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0 && bytes.size() <= SETTINGS_MAX_SIZE) {
+            bytes.insert(bytes.end(), buffer, buffer + count);
+        }
+        const bool ok = !ferror(file);
+        fclose(file);
+        return ok;
+    }
+
+    bool Write(const std::vector<uint8_t>& bytes) override {
+        const std::string temp = m_path + ".tmp";
+        FILE* file = OpenPath(temp.c_str(), true);
+        if (!file) {
+            return false;
+        }
+        bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && CommitFile(file);
+        ok = fclose(file) == 0 && ok;
+        if (!ok || !RenamePath(temp.c_str(), m_path.c_str())) {
+            RemovePath(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& Path() const { return m_path; }
+
+protected:
+    virtual FILE* OpenPath(const char* path, bool write) {
+        return fopen(path, write ? "wb" : "rb");
+    }
+    // Makes everything written to @p file durable before it is renamed into place.
+    virtual bool CommitFile(FILE* file) {
+        if (fflush(file) != 0) {
+            return false;
+        }
+#if defined(__unix__) || defined(__APPLE__)
+        return fsync(fileno(file)) == 0;
+#else
+        return true;
+#endif
+    }
+    virtual bool RenamePath(const char* from, const char* to) {
+        return rename(from, to) == 0;
+    }
+    virtual void RemovePath(const char* path) {
+        remove(path);
+    }
+
+    std::string m_path;
+};
@@ -1,3 +1,10 @@
 #define IDR_TRAYMENU     102
 #define ID_TRAY_EXIT     103
-#define ID_TRAY_RESIZE   104
\ No newline at end of file
+#define ID_TRAY_RESIZE   104
+#define ID_TRAY_GRID_10X6 105
+#define ID_TRAY_GRID_6X5  106
+#define ID_TRAY_FOLLOW   107
+#define ID_TRAY_AUTOHIDE 108
+#define ID_TRAY_PROFILE_NEW    109
+#define ID_TRAY_PROFILE_DELETE 110
+#define ID_TRAY_PROFILE_FIRST  120 // One per profile, up to SETTINGS_MAX_PROFILES.
@@ -4,14 +4,37 @@
  *
  * This application creates a transparent, click-through window with a grid overlay.
  * The user can toggle a "resize mode" with a global hotkey (Ctrl+Alt+G) to
- * move, resize, and place a custom marker dot. The window's last position and
- * dot location are saved to the Windows Registry.
+ * move, resize, and place a custom marker dot. The layout (window position,
+ * grid, dot and cell marks), its profiles and the options are saved to
+ * %APPDATA%\SimpleGridOverlay\settings.dat, or to the registry when there is no
+ * APPDATA folder; see grid_settings.h.
  */
 
 #include <windows.h>
 #include <shellapi.h>
+#include <dwmapi.h>
 #include <wchar.h>
+#include <stdio.h>
+#include <io.h>
+#include <string>
+#include <vector>
 #include "resources.h"
+#include "grid_geometry.h"
+#include "grid_raster.h"
+#include "grid_glyphs.h"
+#include "grid_cells.h"
+#include "grid_render.h"
+#include "grid_plan.h"
+#include "grid_render_gdi.h"
+#include "grid_settings.h"
+
+// Older SDK headers only declare these for newer WINVER targets.
+#ifndef WM_DPICHANGED
+#define WM_DPICHANGED 0x02E0
+#endif
+#ifndef USER_DEFAULT_SCREEN_DPI
+#define USER_DEFAULT_SCREEN_DPI 96
+#endif
 
 //--------------------------------------------------------------------------------------
 // Global Variables and Constants
@@ -21,23 +44,271 @@ HWND g_hWnd = NULL;
 bool g_isResizeMode = false;
 RECT g_windowRect = {100, 100, 900, 600}; // Default window position and size.
 
-// <<< NEW: Custom Dot variables >>>
-POINT g_customDot = {0, 0};
+// Custom dot, in grid space so it stays on the same spot when the grid is resized.
+// Change it through SetCustomDot so the cached pixel position is refreshed.
+GridPoint g_customDot;
 bool g_isDotSet = false;
 
-// Grid dimensions
-const int g_cols = 10;
-const int g_rows = 6;
+/**
+ * @brief The custom dot's client-pixel position, converted from g_customDot for
+ *        one client size and grid. Only recomputed when either changes.
+ */
+struct DotPositionCache {
+    bool valid = false;
+    int width = 0;
+    int height = 0;
+    int cols = 0;
+    int rows = 0;
+    POINT position = {};
+    unsigned long conversions = 0;
+};
+DotPositionCache g_dotCache;
+
+// Grid dimensions. Changed from the tray menu or with /grid COLSxROWS, and saved with the settings.
+int g_cols = 10;
+int g_rows = 6;
+
+// Cell edges for the current client size. Recomputed on WM_SIZE.
+GridGeometry g_geometry;
+
+// Progress mark of every cell. Cleared when the grid size changes, saved with the settings.
+CellStates g_cells;
+
+// Saved layouts. The live layout is the globals above; g_profiles[g_activeProfile]
+// is only brought up to date when switching away or saving. Never empty.
+std::vector<LayoutProfile> g_profiles(1);
+int g_activeProfile = 0;
+
+// Settings records written by a newer version, saved back unchanged.
+std::vector<uint8_t> g_unknownSettingsRecords;
+
+/**
+ * @brief Cell under the mouse in resize mode, whose row and column are highlighted.
+ */
+struct HoverState {
+    bool tracking = false; // TrackMouseEvent armed for WM_MOUSELEAVE.
+    int col = -1;
+    int row = -1;
+};
+HoverState g_hover;
+
+// The first cell marked as an egg blinks gently so it's easy to find the next one to hatch.
+const UINT_PTR BLINK_TIMER_ID = 1;
+const UINT BLINK_INTERVAL_MS = 600;
+const ULONG BLINK_TOLERANCE_MS = 150; // Lets Windows batch the wakeup with other timers.
+
+/**
+ * @brief Blink cue state. The timer only exists while a cell is blinking and the
+ *        overlay is visible over the foreground game, so an idle overlay never wakes.
+ */
+struct Animation {
+    UINT_PTR timer = 0;                   // Non-zero while the blink timer runs.
+    int cell = -1;                        // Cell being blinked.
+    bool lit = false;                     // Whether the cue is drawn this frame.
+    unsigned long wakeups = 0;
+    LARGE_INTEGER runningSince = {};
+    LONGLONG runningTicks = 0;            // QueryPerformanceCounter ticks with the timer running.
+};
+Animation g_animation;
+
+/**
+ * @brief Window-follow mode. The overlay keeps a fixed offset from the target
+ *        window's client area and moves with it. Moves reported by the hook are
+ *        coalesced into one posted message, so a burst of events costs one
+ *        SetWindowPos.
+ */
+struct FollowState {
+    bool enabled = false;           // Saved with the settings.
+    HWND target = NULL;
+    HWINEVENTHOOK hook = NULL;
+    POINT anchor = {};              // Overlay origin relative to the target's client origin.
+    bool pending = false;           // WM_APP_FOLLOW posted but not yet handled.
+    LARGE_INTEGER batchStart = {};  // When the first event of the pending batch arrived.
+    unsigned long events = 0;
+    unsigned long moves = 0;
+    LONGLONG totalLatencyTicks = 0;
+    LONGLONG maxLatencyTicks = 0;
+};
+FollowState g_follow;
+
+/**
+ * @brief Auto-hide mode. While another process is in the foreground the overlay
+ *        is hidden and every timer and hook except the foreground hook is
+ *        released. The retained frame is kept, so showing it again needs no
+ *        rendering.
+ *
+ * The game window is chosen explicitly: the follow target, or the window that
+ * was in the foreground when the user started editing the overlay. Until one is
+ * chosen, and after its process exits, the next eligible window to come to the
+ * foreground is taken.
+ */
+struct AutoHideState {
+    bool enabled = false;       // Saved with the settings.
+    bool hidden = false;
+    HWND target = NULL;         // The game window, or NULL if none is chosen.
+    DWORD processId = 0;        // Process that owns the target.
+    HANDLE process = NULL;      // SYNCHRONIZE handle to that process, signaled when it exits.
+    HANDLE wait = NULL;         // Thread-pool wait on the process, posting WM_APP_TARGET_EXITED.
+    HWND editForeground = NULL; // Foreground window when resize mode was entered.
+};
+AutoHideState g_autoHide;
+
+/**
+ * @brief Background thread that writes settings snapshots to the store, so the
+ *        UI thread never waits on the registry or the disk.
+ *
+ * Snapshots are encoded on the UI thread and handed over under the lock. Only
+ * the newest is kept, and it is written once no newer one has arrived for
+ * SETTINGS_DEBOUNCE_MS, or SETTINGS_MAX_DELAY_MS after the first unwritten one,
+ * whichever is sooner. Without a running thread, snapshots are written directly.
+ */
+struct SettingsWriter {
+    HANDLE thread = NULL;
+    SRWLOCK lock = SRWLOCK_INIT;
+    CONDITION_VARIABLE wake = CONDITION_VARIABLE_INIT;
+    std::vector<uint8_t> pending;   // Newest unwritten snapshot, encoded.
+    bool hasPending = false;
+    bool stopping = false;          // Write what is pending now, then exit.
+    ULONGLONG firstPendingTick = 0; // GetTickCount64 when the oldest unwritten snapshot arrived.
+    ULONGLONG lastPendingTick = 0;
+    unsigned long snapshots = 0;
+    unsigned long writes = 0;
+    unsigned long failures = 0;
+};
+SettingsWriter g_settingsWriter;
+const DWORD SETTINGS_DEBOUNCE_MS = 500;
+const DWORD SETTINGS_MAX_DELAY_MS = 2000;
+
+// Drives the blink cue and auto-hide. Installed for the lifetime of the window.
+HWINEVENTHOOK g_foregroundHook = NULL;
 
 // Application identifiers
 const wchar_t CLASS_NAME[] = L"SimpleGridOverlayClass";
 const wchar_t APP_TITLE[] = L"Grid Overlay";
+const wchar_t SETTINGS_KEY[] = L"Software\\SimpleGridOverlay";
 const UINT WM_APP_TRAY_MSG = WM_APP + 1;
+const UINT WM_APP_FOLLOW = WM_APP + 2; // Posted once per batch of target window moves.
+const UINT WM_APP_TARGET_EXITED = WM_APP + 3; // The auto-hide target's process exited; wParam is its ID.
 const int RESIZE_HOTKEY_ID = 1;
+const int CELL_HOTKEY_ID = 2;
+const int PROFILE_HOTKEY_ID = 3;
 
 // The color used for the transparent background in overlay mode.
 const COLORREF TRANSPARENT_COLOR = RGB(0, 0, 1);
 
+// Drawing colors
+const COLORREF GRID_COLOR = RGB(138, 43, 226);
+const COLORREF LABEL_COLOR = RGB(192, 192, 192);
+const COLORREF DOT_COLOR = RGB(255, 0, 0);
+const int DOT_RADIUS = 5; // At 96 DPI; scaled for the monitor the overlay is on.
+const int DOT_HALO_RADIUS = 10; // At 96 DPI, like DOT_RADIUS.
+const BYTE DOT_HALO_ALPHA = 72;
+const COLORREF EGG_COLOR = RGB(255, 215, 0);
+const COLORREF HATCHED_COLOR = RGB(0, 200, 83);
+const COLORREF FLAGGED_COLOR = RGB(255, 64, 129);
+const BYTE CELL_FILL_ALPHA = 96; // Cell marks let the box show through.
+const int CELL_OUTLINE_WIDTH = 3; // At 96 DPI. Marks are outlined when alpha can't reach the screen.
+const COLORREF BLINK_COLOR = RGB(255, 255, 255);
+const BYTE BLINK_ALPHA = 80;
+const COLORREF HOVER_COLOR = RGB(255, 255, 255);
+const BYTE HOVER_ALPHA = 48;
+
+// How the locked overlay reaches the screen. Chosen at startup with the /alpha switch.
+enum PresentMode {
+    PRESENT_COLOR_KEY,       // WM_PAINT onto a TRANSPARENT_COLOR background, keyed out by the DWM.
+    PRESENT_PER_PIXEL_ALPHA, // Premultiplied ARGB pushed with UpdateLayeredWindow on change only.
+};
+PresentMode g_presentMode = PRESENT_COLOR_KEY;
+
+// GDI label font heights are rounded to this step so a resize drag doesn't rebuild the font every frame.
+const int FONT_HEIGHT_STEP = 2;
+
+// The digit distance field is built once from GDI glyphs of this height, with
+// this many pixels of distance kept around each glyph.
+const int LABEL_ATLAS_FONT_HEIGHT = 64;
+const int LABEL_ATLAS_SPREAD = 8;
+
+// Monitor DPI the overlay currently renders for. Updated on WM_DPICHANGED.
+UINT g_dpi = USER_DEFAULT_SCREEN_DPI;
+
+// How many monitor DPIs keep their render resources alive at once.
+const int DPI_CACHE_SLOTS = 4;
+
+/**
+ * @brief Render resources that depend on the monitor DPI.
+ *
+ * The GDI label font also depends on the window size; it is rebuilt when the
+ * quantized font height changes. Since the window is rescaled
+ * when it moves between monitors, each DPI settles on its own font height.
+ */
+struct DpiResources {
+    UINT dpi = 0; // 0 marks a free slot.
+    HPEN gridPen = NULL;
+    HFONT labelFont = NULL;
+    int labelFontHeight = 0;
+    unsigned long lastUsed = 0;
+};
+
+/**
+ * @brief GDI objects reused across paints. Built once, released on WM_DESTROY.
+ *
+ * DPI-dependent resources live in a few slots keyed by DPI, so dragging the
+ * overlay between monitors swaps slots instead of rebuilding. The counters
+ * record cache lookups so the steady-state paint path can be confirmed to
+ * allocate nothing.
+ */
+struct RenderCache {
+    DpiResources dpiSlots[DPI_CACHE_SLOTS];
+    DpiResources* active = NULL; // Slot for g_dpi, once looked up.
+    GlyphAtlas labelAtlas;       // Resolution-independent, so shared by every DPI.
+    GlyphStrip labelStrip;       // labelAtlas resampled at the last label height drawn.
+    unsigned long useClock = 0;
+    unsigned long hits = 0;
+    unsigned long misses = 0;
+    unsigned long atlasBuilds = 0;
+    unsigned long dpiSlotBuilds = 0;
+};
+RenderCache g_renderCache;
+
+// Display list for the current scene, shared by every window backend.
+RenderPlan g_renderPlan;
+
+/**
+ * @brief Retained DIB-section holding the last rendered frame.
+ *
+ * WM_PAINT only blits from this buffer. It is re-rendered when its generation
+ * lags g_gridGeneration, which is bumped whenever the picture changes.
+ */
+struct BackBuffer {
+    HDC memDC = NULL;
+    HBITMAP bitmap = NULL;
+    HBITMAP oldBitmap = NULL;
+    void* bits = NULL;
+    int width = 0;
+    int height = 0;
+    unsigned long generation = 0;
+};
+BackBuffer g_backBuffer;
+unsigned long g_gridGeneration = 1; // Starts ahead of the buffer so the first paint renders.
+
+// Paint-to-paint intervals during a live resize drag, in FRAME_BUCKET_MS wide buckets.
+// The last bucket collects everything slower.
+const int FRAME_BUCKETS = 8;
+const int FRAME_BUCKET_MS = 4;
+
+/**
+ * @brief Live-resize state. While the user drags the frame, each paint waits for
+ *        the compositor (DwmFlush), so queued size changes coalesce into at most
+ *        one frame per vblank. Frame times are recorded for tuning.
+ */
+struct LiveResize {
+    bool active = false;
+    LARGE_INTEGER lastFrame = {};
+    unsigned long frames = 0;
+    unsigned long buckets[FRAME_BUCKETS] = {};
+};
+LiveResize g_liveResize;
+
 //--------------------------------------------------------------------------------------
 // Forward Declarations
 //--------------------------------------------------------------------------------------
@@ -45,99 +316,1196 @@ void AddTrayIcon(HWND hwnd);
 void RemoveTrayIcon(HWND hwnd);
 void EnterResizeMode(HWND hwnd);
 void ExitResizeMode(HWND hwnd);
+std::wstring Utf8ToWide(const char* text);
+std::string WideToUtf8(const wchar_t* text);
+int FindProfile(const std::string& name);
+std::string NewProfileName();
+void CaptureLayout(LayoutProfile& layout);
+void ApplyLayout(const LayoutProfile& layout);
+bool SwitchProfile(HWND hwnd, int index);
+bool SelectProfileByName(const std::string& name);
+bool AddProfile(HWND hwnd, const std::string& name);
+void DeleteActiveProfile(HWND hwnd);
+void AddProfileMenuItems(HMENU menu);
+void CaptureSettings(OverlaySettings& settings);
+void ApplySettings(const OverlaySettings& settings);
+bool LoadLegacySettings(OverlaySettings& settings);
 void SaveSettings();
 void LoadSettings();
+void StartSettingsWriter();
+void FlushSettings();
+void ReportSettingsStats();
+bool SetGridDimensions(int cols, int rows);
+void AdvanceCellAt(HWND hwnd, int x, int y);
+void InvalidateCell(HWND hwnd, int index);
+void SetCustomDot(const GridPoint& dot);
+POINT GetDotPosition(const GridGeometry& geometry);
+void UpdateAnimation(HWND hwnd);
+HWND GetWindowBeneath(HWND hwnd);
+void StartFollowing(HWND hwnd, HWND target);
+void StopFollowing();
+void ApplyFollow(HWND hwnd);
+void HookFollowTarget();
+void UpdateFollowAnchor(HWND hwnd);
+void SuspendFollowing();
+void ResumeFollowing(HWND hwnd);
+bool IsGameWindowCandidate(HWND window);
+void SetAutoHideTarget(HWND game);
+void ClearAutoHideTarget();
+void UpdateAutoHide(HWND hwnd);
+void SetHoverCell(HWND hwnd, int col, int row);
+void UpdateHover(HWND hwnd, int x, int y);
+void DestroyRenderCache();
+int QuantizeFontHeight(int fontHeight);
+HFONT GetLabelFont(int fontHeight);
+const GridGeometry& GetGridGeometry(int width, int height);
+const GlyphAtlas& GetLabelAtlas();
+void InvalidateGrid(HWND hwnd);
+void InvalidateGridRect(HWND hwnd, const RECT& dirty);
+void DestroyBackBuffer();
+bool EnsureBackBuffer(HDC hdc, int width, int height);
+RasterSurface BackBufferSurface();
+uint32_t BackgroundArgb();
+void PaintFromBackBuffer(HWND hwnd, HDC hdc, const RECT& rcPaint);
+bool PresentLayered(HWND hwnd);
+bool PresentLayeredRect(HWND hwnd, const RECT& dirty);
+void ApplyOverlayLayering(HWND hwnd);
+void EnablePerMonitorDpiAwareness();
+void RecordLiveResizeFrame();
+void ReportLiveResizeFrames();
+UINT GetWindowDpi(HWND hwnd);
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
 /**
- * @brief Renders the grid, column numbers, and custom dot onto the device context.
- * @param hdc The device context to draw on.
+ * @brief Releases every GDI object held by the render cache.
+ */
+void DestroyRenderCache() {
+    for (DpiResources& slot : g_renderCache.dpiSlots) {
+        if (slot.gridPen) DeleteObject(slot.gridPen);
+        if (slot.labelFont) DeleteObject(slot.labelFont);
+    }
+    g_renderCache = RenderCache();
+    g_renderPlan.valid = false; // Its scene points into the slots just released.
+}
+
+/**
+ * @brief Scales a length in 96-DPI pixels to the current monitor DPI.
+ */
+int ScaleForDpi(int value) {
+    return MulDiv(value, (int)g_dpi, USER_DEFAULT_SCREEN_DPI);
+}
+
+/**
+ * @brief Grid line thickness at the current DPI; never thinner than one pixel.
+ */
+int GridLineWidth() {
+    int width = ScaleForDpi(1);
+    return width < 1 ? 1 : width;
+}
+
+/**
+ * @brief Radius of the custom dot at the current DPI.
+ */
+int DotRadius() {
+    return ScaleForDpi(DOT_RADIUS);
+}
+
+/**
+ * @brief Radius of the translucent halo around the custom dot at the current DPI. Only drawn
+ *        when alpha reaches the screen (/alpha or resize mode).
+ */
+int DotHaloRadius() {
+    return ScaleForDpi(DOT_HALO_RADIUS);
+}
+
+/**
+ * @brief Returns the resource slot for g_dpi, recycling the least recently used
+ *        slot when this DPI has not been seen before.
+ */
+DpiResources& ActiveDpiResources() {
+    DpiResources* slot = g_renderCache.active;
+    if (!slot || slot->dpi != g_dpi) {
+        slot = NULL;
+        for (DpiResources& candidate : g_renderCache.dpiSlots) {
+            if (candidate.dpi == g_dpi) {
+                slot = &candidate;
+                break;
+            }
+        }
+        if (!slot) {
+            slot = &g_renderCache.dpiSlots[0];
+            for (DpiResources& candidate : g_renderCache.dpiSlots) {
+                if (candidate.lastUsed < slot->lastUsed) slot = &candidate;
+            }
+            if (slot->gridPen) DeleteObject(slot->gridPen);
+            if (slot->labelFont) DeleteObject(slot->labelFont);
+            *slot = DpiResources();
+            slot->dpi = g_dpi;
+            slot->gridPen = CreatePen(PS_SOLID, GridLineWidth(), GRID_COLOR);
+            ++g_renderCache.dpiSlotBuilds;
+        }
+        g_renderCache.active = slot;
+    }
+    slot->lastUsed = ++g_renderCache.useClock;
+    return *slot;
+}
+
+/**
+ * @brief Rounds a font height down to its FONT_HEIGHT_STEP bucket.
+ */
+int QuantizeFontHeight(int fontHeight) {
+    int quantized = (fontHeight / FONT_HEIGHT_STEP) * FONT_HEIGHT_STEP;
+    return quantized < FONT_HEIGHT_STEP ? FONT_HEIGHT_STEP : quantized;
+}
+
+/**
+ * @brief Returns the column-number font for the given height, rebuilding it only
+ *        when the quantized height differs from the cached one.
+ */
+HFONT GetLabelFont(int fontHeight) {
+    DpiResources& resources = ActiveDpiResources();
+    const int quantized = QuantizeFontHeight(fontHeight);
+
+    if (resources.labelFont && resources.labelFontHeight == quantized) {
+        ++g_renderCache.hits;
+        return resources.labelFont;
+    }
+
+    ++g_renderCache.misses;
+    if (resources.labelFont) DeleteObject(resources.labelFont);
+    resources.labelFont = CreateFont(quantized, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
+                                         DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+                                         g_presentMode == PRESENT_PER_PIXEL_ALPHA ? ANTIALIASED_QUALITY : DEFAULT_QUALITY,
+                                         DEFAULT_PITCH | FF_SWISS, L"Arial");
+    resources.labelFontHeight = quantized;
+    return resources.labelFont;
+}
+
+/**
+ * @brief Returns the digit distance-field atlas, rasterizing the ten digits with
+ *        GDI at the reference size the first time it is needed.
+ */
+const GlyphAtlas& GetLabelAtlas() {
+    GlyphAtlas& atlas = g_renderCache.labelAtlas;
+    if (atlas.fontHeight != 0) {
+        ++g_renderCache.hits;
+        return atlas;
+    }
+
+    ++g_renderCache.atlasBuilds;
+    g_renderCache.labelStrip = GlyphStrip(); // Sampled from the field being replaced.
+    HDC screenDC = GetDC(NULL);
+    HDC dc = CreateCompatibleDC(screenDC);
+    HFONT font = CreateFont(LABEL_ATLAS_FONT_HEIGHT, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
+                            DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY,
+                            DEFAULT_PITCH | FF_SWISS, L"Arial");
+    HFONT hOldFont = (HFONT)SelectObject(dc, font);
+
+    TEXTMETRIC tm;
+    GetTextMetrics(dc, &tm);
+    int advances[10];
+    for (int d = 0; d < 10; ++d) {
+        wchar_t ch = (wchar_t)(L'0' + d);
+        SIZE extent;
+        GetTextExtentPoint32(dc, &ch, 1, &extent);
+        advances[d] = extent.cx;
+    }
+    GlyphAtlasReset(atlas, LABEL_ATLAS_FONT_HEIGHT, advances, tm.tmHeight, LABEL_ATLAS_SPREAD);
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = atlas.width;
+    bmi.bmiHeader.biHeight = -atlas.height;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* bits = NULL;
+    HBITMAP bitmap = CreateDIBSection(screenDC, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+
+    if (bitmap) {
+        HBITMAP hOldBitmap = (HBITMAP)SelectObject(dc, bitmap);
+        RasterSurface strip = RasterMakeSurface((uint32_t*)bits, atlas.width, atlas.height, atlas.width);
+        RasterClear(strip, 0);
+
+        // White on black, so any channel is the glyph's coverage.
+        SetTextColor(dc, RGB(255, 255, 255));
+        SetBkMode(dc, TRANSPARENT);
+        for (int d = 0; d < 10; ++d) {
+            wchar_t ch = (wchar_t)(L'0' + d);
+            TextOut(dc, atlas.glyphX[d], atlas.pad, &ch, 1);
+        }
+        GdiFlush();
+
+        const int count = atlas.width * atlas.height;
+        std::vector<uint8_t> coverage(count);
+        for (int i = 0; i < count; ++i) {
+            // ClearType fringes differ per channel; keep the strongest.
+            uint32_t p = strip.pixels[i];
+            uint32_t r = (p >> 16) & 0xFF, g = (p >> 8) & 0xFF, b = p & 0xFF;
+            uint32_t m = r > g ? r : g;
+            coverage[i] = (uint8_t)(m > b ? m : b);
+        }
+        GlyphAtlasBuildSdf(atlas, coverage.data());
+
+        SelectObject(dc, hOldBitmap);
+        DeleteObject(bitmap);
+    }
+
+    SelectObject(dc, hOldFont);
+    DeleteObject(font);
+    DeleteDC(dc);
+    ReleaseDC(NULL, screenDC);
+    return atlas;
+}
+
+/**
+ * @brief Returns the cell geometry for a client of the given size. The table is
+ *        normally refreshed by WM_SIZE; this only recomputes it on a mismatch.
+ */
+const GridGeometry& GetGridGeometry(int width, int height) {
+    if (!GridGeometryMatches(g_geometry, width, height, g_cols, g_rows)) {
+        GridGeometryUpdate(g_geometry, width, height, g_cols, g_rows);
+    }
+    return g_geometry;
+}
+
+/**
+ * @brief Returns the label font height for a geometry: 60% of the top row.
+ */
+int LabelFontHeight(const GridGeometry& geometry) {
+    return geometry.rowEdge[1] * 3 / 5;
+}
+
+/**
+ * @brief Converts a COLORREF to the rasterizer's premultiplied 0xAARRGGBB format.
+ */
+uint32_t ColorRefToArgb(COLORREF color, BYTE alpha = 255) {
+    return RasterArgb(alpha, GetRValue(color), GetGValue(color), GetBValue(color));
+}
+
+/**
+ * @brief Describes the current overlay state as a scene for the renderer.
+ * @param background Premultiplied fill for everything not covered by the grid.
+ */
+GridScene BuildScene(const GridGeometry& geometry, uint32_t background) {
+    GridScene scene = {};
+    scene.geometry = &geometry;
+    scene.labelFontHeight = (geometry.rows > 0) ? LabelFontHeight(geometry) : 0;
+    scene.labelAtlas = (geometry.rows > 0) ? &GetLabelAtlas() : NULL;
+    scene.labelStrip = &g_renderCache.labelStrip;
+    scene.cells = &g_cells;
+    // Only per-pixel alpha and the opaque resize-mode background let translucency
+    // through; under the color key a blended fill would hide the sprite it marks.
+    scene.translucent = g_presentMode == PRESENT_PER_PIXEL_ALPHA || g_isResizeMode;
+    const BYTE markAlpha = scene.translucent ? CELL_FILL_ALPHA : 255;
+    scene.cellColors[CELL_EGG] = ColorRefToArgb(EGG_COLOR, markAlpha);
+    scene.cellColors[CELL_HATCHED] = ColorRefToArgb(HATCHED_COLOR, markAlpha);
+    scene.cellColors[CELL_FLAGGED] = ColorRefToArgb(FLAGGED_COLOR, markAlpha);
+    scene.cellOutlineWidth = ScaleForDpi(CELL_OUTLINE_WIDTH);
+    scene.blinkCell = g_animation.lit ? g_animation.cell : -1;
+    scene.blinkColor = ColorRefToArgb(BLINK_COLOR, scene.translucent ? BLINK_ALPHA : 255);
+    scene.hoverCol = g_isResizeMode ? g_hover.col : -1;
+    scene.hoverRow = g_isResizeMode ? g_hover.row : -1;
+    scene.hoverColor = ColorRefToArgb(HOVER_COLOR, HOVER_ALPHA);
+    scene.dotSet = g_isDotSet;
+    const POINT dot = GetDotPosition(geometry);
+    scene.dotX = dot.x;
+    scene.dotY = dot.y;
+    scene.dotRadius = DotRadius();
+    scene.dotHaloRadius = DotHaloRadius();
+    scene.dotHaloColor = ColorRefToArgb(DOT_COLOR, DOT_HALO_ALPHA);
+    scene.lineWidth = GridLineWidth();
+    // Partial coverage would blend into the color key and leave dark fringes, so
+    // only anti-alias where the background is opaque or alpha reaches the screen.
+    scene.antialias = scene.translucent;
+    scene.background = background;
+    scene.gridColor = ColorRefToArgb(GRID_COLOR);
+    scene.labelColor = ColorRefToArgb(LABEL_COLOR);
+    scene.dotColor = ColorRefToArgb(DOT_COLOR);
+    return scene;
+}
+
+/**
+ * @brief Rasterizes a complete frame within the surface's clip rectangle.
+ * @param background Premultiplied fill for everything not covered by the grid.
+ */
+void RenderFrame(RasterSurface& surface, uint32_t background) {
+    const GridGeometry& geometry = GetGridGeometry(surface.width, surface.height);
+    RasterBackend backend(surface);
+    RenderPlanDraw(g_renderPlan, backend, BuildScene(geometry, background));
+}
+
+/**
+ * @brief Renders the saved layout without creating a window and writes it to a PPM file.
+ * @return false if the frame could not be written.
+ */
+bool RenderToFile(const wchar_t* path) {
+    const int width = g_windowRect.right - g_windowRect.left;
+    const int height = g_windowRect.bottom - g_windowRect.top;
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    GridGeometry geometry;
+    GridGeometryUpdate(geometry, width, height, g_cols, g_rows);
+    MemoryBackend backend;
+    RenderPlanDraw(g_renderPlan, backend, BuildScene(geometry, 0));
+
+    FILE* file = _wfopen(path, L"wb");
+    if (!file) {
+        return false;
+    }
+    bool written = RasterWritePpm(backend.Surface(), file);
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * @brief Moves the custom dot to @p dot, in grid space.
+ */
+void SetCustomDot(const GridPoint& dot) {
+    g_customDot = dot;
+    g_dotCache.valid = false;
+}
+
+/**
+ * @brief Returns the custom dot's client position for @p geometry, converting
+ *        it only when the geometry or the dot changed since the last call.
+ */
+POINT GetDotPosition(const GridGeometry& geometry) {
+    DotPositionCache& cache = g_dotCache;
+    if (!cache.valid || cache.width != geometry.width || cache.height != geometry.height ||
+        cache.cols != geometry.cols || cache.rows != geometry.rows) {
+        int x, y;
+        GridPointToClient(geometry, g_customDot, &x, &y);
+        cache.position = { x, y };
+        cache.width = geometry.width;
+        cache.height = geometry.height;
+        cache.cols = geometry.cols;
+        cache.rows = geometry.rows;
+        cache.valid = true;
+        ++cache.conversions;
+    }
+    return cache.position;
+}
+
+/**
+ * @brief Returns the pixel bounds of the custom dot and its halo at the current position.
+ */
+RECT GetDotRect() {
+    RECT clientRect;
+    GetClientRect(g_hWnd, &clientRect);
+    const POINT dot = GetDotPosition(GetGridGeometry(clientRect.right, clientRect.bottom));
+    const int radius = DotHaloRadius();
+    RECT rc = { dot.x - radius, dot.y - radius, dot.x + radius, dot.y + radius };
+    return rc;
+}
+
+/**
+ * @brief Renders the grid, column numbers, and custom dot onto the device context with GDI.
+ * @param hdc The device context to draw on.
+ * @param rcPaint Only this rectangle is cleared, and only lines and labels crossing it are emitted.
+ * @param background Premultiplied fill for everything not covered by the grid.
+ */
+void DrawGrid(HDC hdc, const RECT& rcPaint, uint32_t background) {
+    RECT clientRect;
+    GetClientRect(g_hWnd, &clientRect);
+
+    const GridGeometry& geometry = GetGridGeometry(clientRect.right, clientRect.bottom);
+    GdiBackend backend(hdc, rcPaint, ActiveDpiResources().gridPen, GetLabelFont);
+    RenderPlanDraw(g_renderPlan, backend, BuildScene(geometry, background));
+}
+
+/**
+ * @brief Renders a premultiplied ARGB frame into the back buffer and pushes it
+ *        to the compositor with UpdateLayeredWindow.
+ *
+ * Everything is composited by the software rasterizer, which writes
+ * premultiplied pixels directly; labels come from the anti-aliased digit atlas.
+ * @return false if the frame could not be handed to the compositor.
+ */
+bool PresentLayered(HWND hwnd) {
+    RECT windowRect;
+    GetWindowRect(hwnd, &windowRect);
+    const int width = windowRect.right - windowRect.left;
+    const int height = windowRect.bottom - windowRect.top;
+    if (width <= 0 || height <= 0) {
+        return true; // Nothing to show.
+    }
+
+    HDC screenDC = GetDC(NULL);
+    if (!EnsureBackBuffer(screenDC, width, height)) {
+        ReleaseDC(NULL, screenDC);
+        return false;
+    }
+
+    if (g_backBuffer.generation != g_gridGeneration) {
+        RasterSurface surface = BackBufferSurface();
+        RenderFrame(surface, 0);
+        g_backBuffer.generation = g_gridGeneration;
+    }
+
+    POINT dstPos = { windowRect.left, windowRect.top };
+    SIZE size = { width, height };
+    POINT srcPos = { 0, 0 };
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+    BOOL presented = UpdateLayeredWindow(hwnd, screenDC, &dstPos, &size, g_backBuffer.memDC, &srcPos, 0, &blend, ULW_ALPHA);
+    ReleaseDC(NULL, screenDC);
+    return presented != FALSE;
+}
+
+/**
+ * @brief Pushes the current back buffer to the compositor, telling it that only
+ *        @p dirty changed so it can skip recompositing the rest of the window.
+ *
+ * The back buffer must already hold the whole frame at the window's size.
+ * @return false if the update was refused.
+ */
+bool PresentLayeredRect(HWND hwnd, const RECT& dirty) {
+    RECT windowRect;
+    GetWindowRect(hwnd, &windowRect);
+    POINT dstPos = { windowRect.left, windowRect.top };
+    SIZE size = { g_backBuffer.width, g_backBuffer.height };
+    POINT srcPos = { 0, 0 };
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+
+    UPDATELAYEREDWINDOWINFO info = {};
+    info.cbSize = sizeof(info);
+    info.pptDst = &dstPos;
+    info.psize = &size;
+    info.hdcSrc = g_backBuffer.memDC;
+    info.pptSrc = &srcPos;
+    info.pblend = &blend;
+    info.dwFlags = ULW_ALPHA;
+    info.prcDirty = &dirty;
+    return UpdateLayeredWindowIndirect(hwnd, &info) != FALSE;
+}
+
+/**
+ * @brief Applies the locked-mode layered attributes for the active presentation mode.
+ *
+ * UpdateLayeredWindow fails on a window that has had SetLayeredWindowAttributes
+ * called on it until WS_EX_LAYERED is cleared and set again.
+ */
+void ApplyOverlayLayering(HWND hwnd) {
+    if (g_presentMode == PRESENT_PER_PIXEL_ALPHA) {
+        SetWindowLongPtr(hwnd, GWL_EXSTYLE, WS_EX_TRANSPARENT | WS_EX_TOPMOST);
+        SetWindowLongPtr(hwnd, GWL_EXSTYLE, WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST);
+    } else {
+        SetLayeredWindowAttributes(hwnd, TRANSPARENT_COLOR, 0, LWA_COLORKEY);
+        SetWindowLongPtr(hwnd, GWL_EXSTYLE, WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST);
+    }
+}
+
+/**
+ * @brief Marks the retained frame stale and schedules a repaint without erasing,
+ *        or re-presents immediately when the locked overlay uses per-pixel alpha.
+ */
+void InvalidateGrid(HWND hwnd) {
+    ++g_gridGeneration;
+    if (g_autoHide.hidden) {
+        return; // Nothing reaches the screen; UpdateAutoHide redraws before showing.
+    }
+    if (!g_isResizeMode && g_presentMode == PRESENT_PER_PIXEL_ALPHA) {
+        PresentLayered(hwnd); // Layered windows with per-pixel alpha never receive WM_PAINT.
+    } else {
+        InvalidateRect(hwnd, NULL, FALSE);
+    }
+}
+
+/**
+ * @brief Repaints only @p dirty. If the retained frame is current, just that
+ *        rectangle of it is re-rendered and then blitted, or with per-pixel alpha
+ *        presented as a dirty rectangle; otherwise the whole grid is invalidated.
+ */
+void InvalidateGridRect(HWND hwnd, const RECT& dirty) {
+    if (g_autoHide.hidden) {
+        InvalidateGrid(hwnd); // Only marks the frame stale.
+        return;
+    }
+    RECT clientRect, rc;
+    GetClientRect(hwnd, &clientRect);
+    if (!IntersectRect(&rc, &dirty, &clientRect)) {
+        return;
+    }
+
+    const bool usesPaint = g_isResizeMode || g_presentMode == PRESENT_COLOR_KEY;
+    const bool bufferCurrent = g_backBuffer.memDC && g_backBuffer.generation == g_gridGeneration &&
+                               g_backBuffer.width == clientRect.right && g_backBuffer.height == clientRect.bottom;
+    if (!bufferCurrent) {
+        InvalidateGrid(hwnd);
+        return;
+    }
+
+    RasterSurface surface = BackBufferSurface();
+    RasterSetClip(surface, rc.left, rc.top, rc.right, rc.bottom);
+    RenderFrame(surface, usesPaint ? BackgroundArgb() : 0);
+    if (usesPaint) {
+        InvalidateRect(hwnd, &rc, FALSE);
+    } else if (!PresentLayeredRect(hwnd, rc)) {
+        InvalidateGrid(hwnd); // Fall back to a full present.
+    }
+}
+
+/**
+ * @brief Releases the back buffer's DIB section and memory DC.
+ */
+void DestroyBackBuffer() {
+    if (g_backBuffer.memDC) {
+        SelectObject(g_backBuffer.memDC, g_backBuffer.oldBitmap);
+        DeleteDC(g_backBuffer.memDC);
+    }
+    if (g_backBuffer.bitmap) DeleteObject(g_backBuffer.bitmap);
+    g_backBuffer = BackBuffer();
+}
+
+/**
+ * @brief (Re)allocates the back buffer to match the given size.
+ * @return false if the DIB section could not be created.
+ */
+bool EnsureBackBuffer(HDC hdc, int width, int height) {
+    if (g_backBuffer.memDC && g_backBuffer.width == width && g_backBuffer.height == height) {
+        return true;
+    }
+    DestroyBackBuffer();
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height; // Top-down rows.
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    g_backBuffer.memDC = CreateCompatibleDC(hdc);
+    g_backBuffer.bitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &g_backBuffer.bits, NULL, 0);
+    if (!g_backBuffer.memDC || !g_backBuffer.bitmap) {
+        DestroyBackBuffer();
+        return false;
+    }
+    g_backBuffer.oldBitmap = (HBITMAP)SelectObject(g_backBuffer.memDC, g_backBuffer.bitmap);
+    g_backBuffer.width = width;
+    g_backBuffer.height = height;
+    g_backBuffer.generation = 0; // New surface has no content yet.
+    return true;
+}
+
+/**
+ * @brief Returns a rasterizer view of the back buffer's pixels.
+ */
+RasterSurface BackBufferSurface() {
+    return RasterMakeSurface((uint32_t*)g_backBuffer.bits, g_backBuffer.width, g_backBuffer.height, g_backBuffer.width);
+}
+
+/**
+ * @brief Returns the WM_PAINT background color for the current mode.
+ */
+uint32_t BackgroundArgb() {
+    return ColorRefToArgb(g_isResizeMode ? GetSysColor(COLOR_3DFACE) : TRANSPARENT_COLOR);
+}
+
+/**
+ * @brief Copies the invalid region from the retained frame, re-rendering it first if stale.
+ */
+void PaintFromBackBuffer(HWND hwnd, HDC hdc, const RECT& rcPaint) {
+    RECT clientRect;
+    GetClientRect(hwnd, &clientRect);
+    const int width = clientRect.right;
+    const int height = clientRect.bottom;
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    if (!EnsureBackBuffer(hdc, width, height)) {
+        // Out of GDI memory: fall back to drawing straight onto the window.
+        DrawGrid(hdc, rcPaint, BackgroundArgb());
+        return;
+    }
+
+    if (g_backBuffer.generation != g_gridGeneration) {
+        RasterSurface surface = BackBufferSurface();
+        RenderFrame(surface, BackgroundArgb());
+        g_backBuffer.generation = g_gridGeneration;
+    }
+
+    BitBlt(hdc, rcPaint.left, rcPaint.top,
+           rcPaint.right - rcPaint.left, rcPaint.bottom - rcPaint.top,
+           g_backBuffer.memDC, rcPaint.left, rcPaint.top, SRCCOPY);
+}
+
+/**
+ * @brief Opts into per-monitor v2 DPI awareness so Windows never bitmap-stretches
+ *        the overlay. Resolved at runtime because the API needs Windows 10 1703;
+ *        older systems fall back to system DPI awareness.
+ */
+void EnablePerMonitorDpiAwareness() {
+    typedef BOOL (WINAPI *SetProcessDpiAwarenessContextFn)(HANDLE);
+    const HANDLE PER_MONITOR_AWARE_V2 = (HANDLE)(LONG_PTR)-4; // DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2
+
+    HMODULE user32 = GetModuleHandle(L"user32.dll");
+    SetProcessDpiAwarenessContextFn setContext =
+        (SetProcessDpiAwarenessContextFn)GetProcAddress(user32, "SetProcessDpiAwarenessContext");
+    if (!setContext || !setContext(PER_MONITOR_AWARE_V2)) {
+        SetProcessDPIAware();
+    }
+}
+
+/**
+ * @brief Returns the DPI of the monitor the window is on.
+ */
+UINT GetWindowDpi(HWND hwnd) {
+    typedef UINT (WINAPI *GetDpiForWindowFn)(HWND);
+    GetDpiForWindowFn getDpi = (GetDpiForWindowFn)GetProcAddress(GetModuleHandle(L"user32.dll"), "GetDpiForWindow");
+    if (getDpi) {
+        UINT dpi = getDpi(hwnd);
+        if (dpi) return dpi;
+    }
+    HDC screenDC = GetDC(NULL);
+    UINT dpi = (UINT)GetDeviceCaps(screenDC, LOGPIXELSX);
+    ReleaseDC(NULL, screenDC);
+    return dpi ? dpi : USER_DEFAULT_SCREEN_DPI;
+}
+
+/**
+ * @brief Changes the grid to cols x rows, up to GRID_MAX_CELLS a side. Cell
+ *        marks are cleared when the size actually changes; the dot keeps its place.
+ * @return false if the dimensions are out of range; the grid is left unchanged.
+ */
+bool SetGridDimensions(int cols, int rows) {
+    if (cols <= 0 || rows <= 0 || cols > GRID_MAX_CELLS || rows > GRID_MAX_CELLS) {
+        return false;
+    }
+    if (cols != g_cols || rows != g_rows) {
+        CellStatesClear(g_cells);
+        g_hover.col = g_hover.row = -1;
+        // Keep the dot at the same place in the overlay rather than in the same cell.
+        GridPoint dot;
+        dot.col = g_customDot.col * cols / g_cols;
+        dot.row = g_customDot.row * rows / g_rows;
+        SetCustomDot(dot);
+    }
+    g_cols = cols;
+    g_rows = rows;
+    GridGeometryUpdate(g_geometry, g_geometry.width, g_geometry.height, g_cols, g_rows);
+    return true;
+}
+
+/**
+ * @brief Advances the mark of the cell under the client point (x, y) and
+ *        repaints just that cell.
+ */
+void AdvanceCellAt(HWND hwnd, int x, int y) {
+    RECT clientRect;
+    GetClientRect(hwnd, &clientRect);
+    const GridGeometry& geometry = GetGridGeometry(clientRect.right, clientRect.bottom);
+    int col, row;
+    if (!GridCellFromPoint(geometry, x, y, &col, &row)) {
+        return;
+    }
+    CellStatesAdvance(g_cells, row * geometry.cols + col);
+    InvalidateCell(hwnd, row * geometry.cols + col);
+    UpdateAnimation(hwnd); // The cell to blink may have changed.
+    SaveSettings();
+}
+
+/**
+ * @brief Repaints the cell with the given row-major index.
+ */
+void InvalidateCell(HWND hwnd, int index) {
+    RECT clientRect;
+    GetClientRect(hwnd, &clientRect);
+    const GridGeometry& geometry = GetGridGeometry(clientRect.right, clientRect.bottom);
+    if (index < 0 || index >= geometry.cols * geometry.rows) {
+        return;
+    }
+    int left, top, right, bottom;
+    GridCellBounds(geometry, index % geometry.cols, index / geometry.cols, &left, &top, &right, &bottom);
+    RECT dirty = { left, top, right, bottom };
+    InvalidateGridRect(hwnd, dirty);
+}
+
+/**
+ * @brief Returns true if the overlay is on screen and either it or the game's
+ *        process is in the foreground. With no game chosen yet, being on
+ *        screen is enough.
+ */
+bool IsOverlayInUse(HWND hwnd) {
+    if (!IsWindowVisible(hwnd) || IsIconic(hwnd)) {
+        return false;
+    }
+    HWND foreground = GetForegroundWindow();
+    if (foreground == hwnd || !g_autoHide.processId) {
+        return true;
+    }
+    DWORD processId = 0;
+    if (foreground) {
+        GetWindowThreadProcessId(foreground, &processId);
+    }
+    return processId == g_autoHide.processId;
+}
+
+/**
+ * @brief Returns the top-level window under the overlay's center, or NULL.
+ *        The locked overlay is transparent to hit-testing, so this is the game.
+ */
+HWND GetWindowBeneath(HWND hwnd) {
+    RECT windowRect;
+    GetWindowRect(hwnd, &windowRect);
+    POINT center = { (windowRect.left + windowRect.right) / 2, (windowRect.top + windowRect.bottom) / 2 };
+    HWND beneath = WindowFromPoint(center);
+    HWND root = beneath ? GetAncestor(beneath, GA_ROOT) : NULL;
+    return root == hwnd ? NULL : root;
+}
+
+/**
+ * @brief Starts the blink timer, coalescable where the system supports it (Windows 8+).
+ */
+UINT_PTR StartBlinkTimer(HWND hwnd) {
+    typedef UINT_PTR (WINAPI *SetCoalescableTimerFn)(HWND, UINT_PTR, UINT, TIMERPROC, ULONG);
+    SetCoalescableTimerFn setCoalescable =
+        (SetCoalescableTimerFn)GetProcAddress(GetModuleHandle(L"user32.dll"), "SetCoalescableTimer");
+    if (setCoalescable) {
+        return setCoalescable(hwnd, BLINK_TIMER_ID, BLINK_INTERVAL_MS, NULL, BLINK_TOLERANCE_MS);
+    }
+    return SetTimer(hwnd, BLINK_TIMER_ID, BLINK_INTERVAL_MS, NULL);
+}
+
+/**
+ * @brief Starts, stops or retargets the blink cue to match the cell marks and
+ *        whether the overlay is in use. Only the affected cells are repainted.
+ */
+void UpdateAnimation(HWND hwnd) {
+    const int cell = IsOverlayInUse(hwnd) ? CellStatesFindFirst(g_cells, g_cols * g_rows, CELL_EGG) : -1;
+    if (cell == g_animation.cell && (cell < 0) == (g_animation.timer == 0)) {
+        return;
+    }
+
+    if (g_animation.lit) {
+        g_animation.lit = false;
+        InvalidateCell(hwnd, g_animation.cell);
+    }
+    g_animation.cell = cell;
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    if (cell < 0 && g_animation.timer) {
+        KillTimer(hwnd, BLINK_TIMER_ID);
+        g_animation.timer = 0;
+        g_animation.runningTicks += now.QuadPart - g_animation.runningSince.QuadPart;
+    } else if (cell >= 0 && !g_animation.timer) {
+        g_animation.timer = StartBlinkTimer(hwnd);
+        g_animation.runningSince = now;
+    }
+    if (cell >= 0) {
+        g_animation.lit = true;
+        InvalidateCell(hwnd, cell);
+    }
+}
+
+/**
+ * @brief Toggles the blink cue, or stops it if the overlay is no longer in use.
+ */
+void OnBlinkTimer(HWND hwnd) {
+    ++g_animation.wakeups;
+    if (!IsOverlayInUse(hwnd)) {
+        UpdateAnimation(hwnd);
+        return;
+    }
+    g_animation.lit = !g_animation.lit;
+    InvalidateCell(hwnd, g_animation.cell);
+}
+
+/**
+ * @brief Foreground changes can hide or show the overlay and start or stop the blink.
+ *        With no game chosen, the new foreground window becomes the game if it can be one.
+ */
+void CALLBACK ForegroundEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+                                  DWORD idEventThread, DWORD dwmsEventTime) {
+    if (g_hWnd) {
+        if (!g_autoHide.target && !g_isResizeMode) {
+            SetAutoHideTarget(hwnd);
+        }
+        UpdateAutoHide(g_hWnd);
+        UpdateAnimation(g_hWnd);
+    }
+}
+
+/**
+ * @brief Returns true if @p window can be the game: a live window of another
+ *        process that is neither the desktop nor the shell.
+ */
+bool IsGameWindowCandidate(HWND window) {
+    if (!window || !IsWindow(window) || window == GetDesktopWindow() || window == GetShellWindow()) {
+        return false;
+    }
+    DWORD processId = 0;
+    GetWindowThreadProcessId(window, &processId);
+    return processId && processId != GetCurrentProcessId();
+}
+
+/**
+ * @brief Runs on a thread-pool thread when the target's process exits; hands
+ *        the exit to the UI thread.
+ */
+void CALLBACK OnAutoHideTargetExited(PVOID context, BOOLEAN timedOut) {
+    PostMessage(g_hWnd, WM_APP_TARGET_EXITED, (WPARAM)context, 0);
+}
+
+/**
+ * @brief Makes @p game the window whose process keeps the overlay shown, and
+ *        waits on that process so a new game is picked when it exits. Does
+ *        nothing if @p game can't be the game.
+ */
+void SetAutoHideTarget(HWND game) {
+    if (!IsGameWindowCandidate(game) || game == g_autoHide.target) {
+        return;
+    }
+    ClearAutoHideTarget();
+    g_autoHide.target = game;
+    GetWindowThreadProcessId(game, &g_autoHide.processId);
+    g_autoHide.process = OpenProcess(SYNCHRONIZE, FALSE, g_autoHide.processId);
+    if (g_autoHide.process &&
+        !RegisterWaitForSingleObject(&g_autoHide.wait, g_autoHide.process, OnAutoHideTargetExited,
+                                     (PVOID)(ULONG_PTR)g_autoHide.processId, INFINITE, WT_EXECUTEONLYONCE)) {
+        g_autoHide.wait = NULL;
+    }
+}
+
+/**
+ * @brief Forgets the game and releases the wait on its process.
+ */
+void ClearAutoHideTarget() {
+    if (g_autoHide.wait) {
+        UnregisterWaitEx(g_autoHide.wait, INVALID_HANDLE_VALUE); // Returns once a running callback is done.
+        g_autoHide.wait = NULL;
+    }
+    if (g_autoHide.process) {
+        CloseHandle(g_autoHide.process);
+        g_autoHide.process = NULL;
+    }
+    g_autoHide.target = NULL;
+    g_autoHide.processId = 0;
+}
+
+/**
+ * @brief Hides the overlay when auto-hide is on and neither the game's process
+ *        nor the overlay is in the foreground; shows it again otherwise.
+ *
+ * Showing only re-presents the retained frame: a layered window keeps its
+ * bitmap while hidden, and WM_PAINT blits from the back buffer. Changes made
+ * while hidden are not drawn or presented until then.
+ */
+void UpdateAutoHide(HWND hwnd) {
+    bool hide = false;
+    if (g_autoHide.enabled && !g_isResizeMode && g_autoHide.processId) {
+        HWND foreground = GetForegroundWindow();
+        DWORD processId = 0;
+        if (foreground) {
+            GetWindowThreadProcessId(foreground, &processId);
+        }
+        hide = foreground != hwnd && processId != g_autoHide.processId;
+    }
+    if (hide == g_autoHide.hidden) {
+        return;
+    }
+
+    g_autoHide.hidden = hide;
+    if (hide) {
+        ShowWindow(hwnd, SW_HIDE);
+        SuspendFollowing();
+        UpdateAnimation(hwnd); // Kills the blink timer now that the overlay is hidden.
+    } else {
+        ResumeFollowing(hwnd); // Catch up with any move made while hidden before showing.
+        if (g_backBuffer.generation != g_gridGeneration) {
+            InvalidateGrid(hwnd); // Something changed while hidden.
+        }
+        ShowWindow(hwnd, SW_SHOWNA);
+    }
+}
+
+/**
+ * @brief Location changes of the target window. Runs on this thread's message
+ *        loop; only records the event and posts one WM_APP_FOLLOW per batch.
+ */
+void CALLBACK FollowEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+                              DWORD idEventThread, DWORD dwmsEventTime) {
+    if (hwnd != g_follow.target || idObject != OBJID_WINDOW || idChild != CHILDID_SELF) {
+        return;
+    }
+    ++g_follow.events;
+    if (!g_follow.pending) {
+        g_follow.pending = true;
+        QueryPerformanceCounter(&g_follow.batchStart);
+        PostMessage(g_hWnd, WM_APP_FOLLOW, 0, 0);
+    }
+}
+
+/**
+ * @brief Anchors the overlay to @p target's client area at its current offset and
+ *        starts listening for the target's moves. Only that thread's events are hooked.
+ */
+void StartFollowing(HWND hwnd, HWND target) {
+    StopFollowing();
+    if (!target) {
+        return;
+    }
+    g_follow.target = target;
+    UpdateFollowAnchor(hwnd);
+    HookFollowTarget();
+    if (!g_follow.hook) {
+        g_follow.target = NULL;
+    }
+}
+
+/**
+ * @brief Records the overlay's current offset from the follow target's client
+ *        area, which must be set, as the offset to keep.
+ */
+void UpdateFollowAnchor(HWND hwnd) {
+    RECT windowRect;
+    GetWindowRect(hwnd, &windowRect);
+    POINT origin = { 0, 0 };
+    ClientToScreen(g_follow.target, &origin);
+    g_follow.anchor.x = windowRect.left - origin.x;
+    g_follow.anchor.y = windowRect.top - origin.y;
+}
+
+/**
+ * @brief Hooks location changes of the follow target, which must be set.
+ */
+void HookFollowTarget() {
+    DWORD processId = 0;
+    DWORD threadId = GetWindowThreadProcessId(g_follow.target, &processId);
+    g_follow.hook = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE, NULL, FollowEventProc,
+                                    processId, threadId, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+}
+
+/**
+ * @brief Releases the location hook but keeps the target and anchor, for auto-hide.
+ */
+void SuspendFollowing() {
+    if (g_follow.hook) {
+        UnhookWinEvent(g_follow.hook);
+        g_follow.hook = NULL;
+    }
+    g_follow.pending = false;
+}
+
+/**
+ * @brief Re-hooks a suspended target and moves the overlay to where it should be now.
+ */
+void ResumeFollowing(HWND hwnd) {
+    if (!g_follow.target || g_follow.hook) {
+        return;
+    }
+    HookFollowTarget();
+    QueryPerformanceCounter(&g_follow.batchStart);
+    ApplyFollow(hwnd);
+}
+
+/**
+ * @brief Stops tracking the target window. The overlay stays where it is.
+ */
+void StopFollowing() {
+    if (g_follow.hook) {
+        UnhookWinEvent(g_follow.hook);
+    }
+    g_follow.hook = NULL;
+    g_follow.target = NULL;
+    g_follow.pending = false;
+}
+
+/**
+ * @brief Moves the overlay to the target's current client origin plus the anchor,
+ *        with one SetWindowPos, and records how long the batch waited.
+ */
+void ApplyFollow(HWND hwnd) {
+    g_follow.pending = false;
+    if (!g_follow.target) {
+        return;
+    }
+    if (!IsWindow(g_follow.target)) {
+        StopFollowing(); // The game closed.
+        return;
+    }
+    if (g_isResizeMode || IsIconic(g_follow.target)) {
+        return; // Don't fight the user's drag, or chase a minimized window off-screen.
+    }
+
+    POINT origin = { 0, 0 };
+    ClientToScreen(g_follow.target, &origin);
+    RECT windowRect;
+    GetWindowRect(hwnd, &windowRect);
+    const int x = origin.x + g_follow.anchor.x;
+    const int y = origin.y + g_follow.anchor.y;
+    if (x != windowRect.left || y != windowRect.top) {
+        SetWindowPos(hwnd, NULL, x, y, 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
+        ++g_follow.moves;
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    const LONGLONG latency = now.QuadPart - g_follow.batchStart.QuadPart;
+    g_follow.totalLatencyTicks += latency;
+    if (latency > g_follow.maxLatencyTicks) g_follow.maxLatencyTicks = latency;
+}
+
+/**
+ * @brief Writes follow-mode event, move and latency counters to the debugger output.
  */
-void DrawGrid(HDC hdc) {
-    RECT clientRect;
-    GetClientRect(g_hWnd, &clientRect);
+void ReportFollowStats() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    const double averageMs = g_follow.moves ? g_follow.totalLatencyTicks * 1000.0 / frequency.QuadPart / g_follow.moves : 0.0;
+    wchar_t line[160];
+    swprintf(line, 160, L"Grid Overlay: follow %lu events, %lu moves, latency avg %.2f ms, max %.2f ms\n",
+             g_follow.events, g_follow.moves, averageMs, g_follow.maxLatencyTicks * 1000.0 / frequency.QuadPart);
+    OutputDebugString(line);
+}
 
-    const int width = clientRect.right;
-    const int height = clientRect.bottom;
+/**
+ * @brief Writes the blink timer's wakeup count and rate to the debugger output.
+ */
+void ReportAnimationStats() {
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    LONGLONG ticks = g_animation.runningTicks;
+    if (g_animation.timer) {
+        ticks += now.QuadPart - g_animation.runningSince.QuadPart;
+    }
+    const double seconds = (double)ticks / frequency.QuadPart;
+    wchar_t line[128];
+    swprintf(line, 128, L"Grid Overlay: blink timer %lu wakeups in %.1f s running (%.2f/s)\n",
+             g_animation.wakeups, seconds, seconds > 0.0 ? g_animation.wakeups / seconds : 0.0);
+    OutputDebugString(line);
+}
 
-    if (g_cols <= 0 || g_rows <= 0) {
+/**
+ * @brief Moves the hover highlight to (col, row), where -1 means none.
+ *
+ * Only strips whose highlight actually changes are repainted: moving along a
+ * row leaves the row strip alone, and staying in the same cell does nothing.
+ */
+void SetHoverCell(HWND hwnd, int col, int row) {
+    if (col == g_hover.col && row == g_hover.row) {
         return;
     }
+    const int oldCol = g_hover.col;
+    const int oldRow = g_hover.row;
+    g_hover.col = col;
+    g_hover.row = row;
 
-    const float cellWidth = (float)width / g_cols;
-    const float cellHeight = (float)height / g_rows;
-
-    // --- Grid Line Drawing ---
-    HPEN hPen = CreatePen(PS_SOLID, 1, RGB(138, 43, 226));
-    HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
-
-    for (int i = 1; i < g_cols; ++i) {
-        int x = (int)(i * cellWidth);
-        MoveToEx(hdc, x, 0, NULL);
-        LineTo(hdc, x, height);
+    RECT clientRect;
+    GetClientRect(hwnd, &clientRect);
+    const GridGeometry& geometry = GetGridGeometry(clientRect.right, clientRect.bottom);
+    if (col != oldCol) {
+        if (oldCol >= 0 && oldCol < geometry.cols) {
+            RECT strip = { geometry.colEdge[oldCol], 0, geometry.colEdge[oldCol + 1], geometry.height };
+            InvalidateGridRect(hwnd, strip);
+        }
+        if (col >= 0) {
+            RECT strip = { geometry.colEdge[col], 0, geometry.colEdge[col + 1], geometry.height };
+            InvalidateGridRect(hwnd, strip);
+        }
     }
-    for (int i = 1; i < g_rows; ++i) {
-        int y = (int)(i * cellHeight);
-        MoveToEx(hdc, 0, y, NULL);
-        LineTo(hdc, width, y);
+    if (row != oldRow) {
+        if (oldRow >= 0 && oldRow < geometry.rows) {
+            RECT strip = { 0, geometry.rowEdge[oldRow], geometry.width, geometry.rowEdge[oldRow + 1] };
+            InvalidateGridRect(hwnd, strip);
+        }
+        if (row >= 0) {
+            RECT strip = { 0, geometry.rowEdge[row], geometry.width, geometry.rowEdge[row + 1] };
+            InvalidateGridRect(hwnd, strip);
+        }
     }
+}
 
-    SelectObject(hdc, hOldPen);
-    DeleteObject(hPen);
-
-    // --- Number Drawing ---
-    int fontHeight = (int)(cellHeight * 0.6);
-    HFONT hFont = CreateFont(fontHeight, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
-                             DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-                             DEFAULT_QUALITY, DEFAULT_PITCH | FF_SWISS, L"Arial");
-    HFONT hOldFont = (HFONT)SelectObject(hdc, hFont);
-
-    SetTextColor(hdc, RGB(192, 192, 192));
-    SetBkMode(hdc, TRANSPARENT);
-
-    wchar_t numberStr[4];
-    for (int i = 0; i < g_cols; ++i) {
-        swprintf(numberStr, 4, L"%d", i + 1);
-        RECT cellRect = { (int)(i * cellWidth), 0, (int)((i + 1) * cellWidth), (int)cellHeight };
-        DrawText(hdc, numberStr, -1, &cellRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+/**
+ * @brief Highlights the row and column under the client point (x, y), arming
+ *        WM_MOUSELEAVE on the first move so the highlight clears on exit.
+ */
+void UpdateHover(HWND hwnd, int x, int y) {
+    if (!g_hover.tracking) {
+        TRACKMOUSEEVENT tme = {};
+        tme.cbSize = sizeof(tme);
+        tme.dwFlags = TME_LEAVE;
+        tme.hwndTrack = hwnd;
+        g_hover.tracking = TrackMouseEvent(&tme) != FALSE;
     }
 
-    SelectObject(hdc, hOldFont);
-    DeleteObject(hFont);
-
-    // --- <<< NEW: Custom Dot Drawing >>> ---
-    if (g_isDotSet) {
-        HBRUSH hDotBrush = CreateSolidBrush(RGB(255, 0, 0)); // Bright red brush
-        HPEN hDotPen = CreatePen(PS_NULL, 0, 0); // No border for the dot
-        
-        HBRUSH hOldBrush = (HBRUSH)SelectObject(hdc, hDotBrush);
-        HPEN hOldDotPen = (HPEN)SelectObject(hdc, hDotPen);
+    RECT clientRect;
+    GetClientRect(hwnd, &clientRect);
+    int col, row;
+    if (!GridCellFromPoint(GetGridGeometry(clientRect.right, clientRect.bottom), x, y, &col, &row)) {
+        col = row = -1;
+    }
+    SetHoverCell(hwnd, col, row);
+}
 
-        // Draw a circle (ellipse) with a 5-pixel radius centered on the stored point.
-        Ellipse(hdc, g_customDot.x - 5, g_customDot.y - 5, g_customDot.x + 5, g_customDot.y + 5);
+/**
+ * @brief Records the time since the previous live-resize frame in the histogram.
+ */
+void RecordLiveResizeFrame() {
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    if (g_liveResize.frames > 0) {
+        QueryPerformanceFrequency(&frequency);
+        LONGLONG elapsedMs = (now.QuadPart - g_liveResize.lastFrame.QuadPart) * 1000 / frequency.QuadPart;
+        LONGLONG bucket = elapsedMs / FRAME_BUCKET_MS;
+        ++g_liveResize.buckets[bucket < FRAME_BUCKETS ? bucket : FRAME_BUCKETS - 1];
+    }
+    g_liveResize.lastFrame = now;
+    ++g_liveResize.frames;
+}
 
-        SelectObject(hdc, hOldBrush);
-        SelectObject(hdc, hOldDotPen);
-        DeleteObject(hDotBrush);
-        DeleteObject(hDotPen);
+/**
+ * @brief Writes the frame-time histogram of the last resize drag to the debugger output.
+ */
+void ReportLiveResizeFrames() {
+    wchar_t line[128];
+    swprintf(line, 128, L"Grid Overlay: live resize painted %lu frames\n", g_liveResize.frames);
+    OutputDebugString(line);
+    for (int i = 0; i < FRAME_BUCKETS; ++i) {
+        if (i < FRAME_BUCKETS - 1) {
+            swprintf(line, 128, L"  %2d-%2d ms: %lu\n", i * FRAME_BUCKET_MS, (i + 1) * FRAME_BUCKET_MS, g_liveResize.buckets[i]);
+        } else {
+            swprintf(line, 128, L"  >=%2d ms: %lu\n", i * FRAME_BUCKET_MS, g_liveResize.buckets[i]);
+        }
+        OutputDebugString(line);
     }
 }
 
+/**
+ * @brief Writes the render cache and display list counters to the debugger output.
+ */
+void ReportRenderStats() {
+    wchar_t line[160];
+    swprintf(line, 160, L"Grid Overlay: cache %lu hits, %lu misses, %lu atlas builds, %lu DPI slot builds\n",
+             g_renderCache.hits, g_renderCache.misses, g_renderCache.atlasBuilds, g_renderCache.dpiSlotBuilds);
+    OutputDebugString(line);
+    swprintf(line, 160, L"Grid Overlay: render plan %lu rebuilds, %lu replays\n", g_renderPlan.rebuilds, g_renderPlan.replays);
+    OutputDebugString(line);
+    swprintf(line, 160, L"Grid Overlay: dot position %lu conversions\n", g_dotCache.conversions);
+    OutputDebugString(line);
+}
+
 /**
  * @brief Switches the window to an interactive, non-click-through resize mode.
  */
 void EnterResizeMode(HWND hwnd) {
     g_isResizeMode = true;
+    g_autoHide.editForeground = GetForegroundWindow(); // The window being aligned to, unless it's us.
+    UpdateAutoHide(hwnd); // Never hidden while being edited.
     SetLayeredWindowAttributes(hwnd, 0, 254, LWA_ALPHA);
     SetWindowLongPtr(hwnd, GWL_EXSTYLE, WS_EX_LAYERED | WS_EX_TOPMOST);
     SetWindowLongPtr(hwnd, GWL_STYLE, WS_VISIBLE | WS_CAPTION | WS_SYSMENU | WS_SIZEBOX);
     
     // <<< CHANGE: Updated instructions in title bar >>>
-    SetWindowText(hwnd, L"Resize | L-Click: Place Dot | R-Click: Remove | ESC: Lock");
+    SetWindowText(hwnd, L"Resize | L-Click: Place Dot | Ctrl+Click: Mark Cell | R-Click: Remove | ESC: Lock");
 
     SetWindowPos(hwnd, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_FRAMECHANGED);
     SetForegroundWindow(hwnd);
-    InvalidateRect(hwnd, NULL, TRUE);
+    InvalidateGrid(hwnd);
 }
 
 /**
@@ -145,57 +1513,484 @@ void EnterResizeMode(HWND hwnd) {
  */
 void ExitResizeMode(HWND hwnd) {
     g_isResizeMode = false;
+    g_hover = HoverState(); // The full repaint below drops the highlight.
     GetWindowRect(hwnd, &g_windowRect);
-    SetLayeredWindowAttributes(hwnd, TRANSPARENT_COLOR, 0, LWA_COLORKEY);
-    SetWindowLongPtr(hwnd, GWL_EXSTYLE, WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST);
+    ApplyOverlayLayering(hwnd);
     SetWindowLongPtr(hwnd, GWL_STYLE, WS_POPUP | WS_VISIBLE);
     SetWindowText(hwnd, APP_TITLE);
     SetWindowPos(hwnd, HWND_TOPMOST,
                  g_windowRect.left, g_windowRect.top,
                  g_windowRect.right - g_windowRect.left, g_windowRect.bottom - g_windowRect.top,
                  SWP_FRAMECHANGED);
+    InvalidateGrid(hwnd);
+    if (g_follow.enabled) {
+        StartFollowing(hwnd, GetWindowBeneath(hwnd)); // Re-anchor where the user just aligned it.
+    }
+    SetAutoHideTarget(g_follow.target ? g_follow.target : g_autoHide.editForeground);
+    g_autoHide.editForeground = NULL;
     
     SaveSettings(); // Save all settings, including the dot's state.
 }
 
+//--------------------------------------------------------------------------------------
+// Layout Profiles
+//--------------------------------------------------------------------------------------
+
 /**
- * @brief Saves window position and custom dot state to the registry.
+ * @brief Returns the index of the profile called @p name, or -1.
  */
-void SaveSettings() {
-    HKEY hKey;
-    if (RegCreateKeyEx(HKEY_CURRENT_USER, L"Software\\SimpleGridOverlay", 0, NULL, REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, NULL) == ERROR_SUCCESS) {
-        GetWindowRect(g_hWnd, &g_windowRect);
-        RegSetValueEx(hKey, L"windowRect", 0, REG_BINARY, (const BYTE*)&g_windowRect, sizeof(g_windowRect));
-        
-        // <<< NEW: Save dot state and position >>>
-        RegSetValueEx(hKey, L"isDotSet", 0, REG_DWORD, (const BYTE*)&g_isDotSet, sizeof(g_isDotSet));
-        if (g_isDotSet) {
-            RegSetValueEx(hKey, L"customDot", 0, REG_BINARY, (const BYTE*)&g_customDot, sizeof(g_customDot));
+int FindProfile(const std::string& name) {
+    for (size_t i = 0; i < g_profiles.size(); ++i) {
+        if (g_profiles[i].name == name) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Makes profile @p index the live layout. The current layout is stored
+ *        in its slot, the new one is copied out of g_profiles and the window is
+ *        moved with a single SetWindowPos; nothing is read from the settings store.
+ * @param hwnd The overlay, or NULL before it exists.
+ * @return false if @p index is out of range or already active.
+ */
+bool SwitchProfile(HWND hwnd, int index) {
+    if (index < 0 || index >= (int)g_profiles.size() || index == g_activeProfile) {
+        return false;
+    }
+    CaptureLayout(g_profiles[g_activeProfile]);
+    g_activeProfile = index;
+    ApplyLayout(g_profiles[index]);
+
+    if (hwnd) {
+        SetWindowPos(hwnd, NULL, g_windowRect.left, g_windowRect.top, g_windowRect.right - g_windowRect.left,
+                     g_windowRect.bottom - g_windowRect.top, SWP_NOZORDER | SWP_NOACTIVATE);
+        InvalidateGrid(hwnd); // The marks and dot change even when the size doesn't.
+        if (g_follow.target) {
+            UpdateFollowAnchor(hwnd); // Keep following at the new layout's offset.
+        }
+        UpdateAnimation(hwnd);
+    }
+    return true;
+}
+
+/**
+ * @brief Adds a profile called @p name holding a copy of the live layout and switches to it.
+ * @return false if there are already SETTINGS_MAX_PROFILES profiles.
+ */
+bool AddProfile(HWND hwnd, const std::string& name) {
+    if ((int)g_profiles.size() >= SETTINGS_MAX_PROFILES) {
+        return false;
+    }
+    LayoutProfile profile;
+    CaptureLayout(profile);
+    // Truncate without splitting a UTF-8 sequence.
+    size_t length = name.size() < SETTINGS_MAX_PROFILE_NAME ? name.size() : SETTINGS_MAX_PROFILE_NAME;
+    while (length < name.size() && length > 0 && (name[length] & 0xC0) == 0x80) {
+        --length;
+    }
+    profile.name = name.substr(0, length);
+    g_profiles.push_back(profile);
+    return SwitchProfile(hwnd, (int)g_profiles.size() - 1);
+}
+
+/**
+ * @brief Switches to the profile called @p name, creating it from the live
+ *        layout if there is none. Used for /profile before the window exists.
+ */
+bool SelectProfileByName(const std::string& name) {
+    const int index = FindProfile(name);
+    if (index < 0) {
+        return AddProfile(NULL, name);
+    }
+    SwitchProfile(NULL, index);
+    return true;
+}
+
+/**
+ * @brief Returns "Layout N" for the lowest N not already taken.
+ */
+std::string NewProfileName() {
+    for (int n = (int)g_profiles.size() + 1;; ++n) {
+        char name[32];
+        snprintf(name, sizeof(name), "Layout %d", n);
+        if (FindProfile(name) < 0) {
+            return name;
+        }
+    }
+}
+
+/**
+ * @brief Deletes the active profile and switches to its neighbour. The last
+ *        profile can't be deleted.
+ */
+void DeleteActiveProfile(HWND hwnd) {
+    if (g_profiles.size() <= 1) {
+        return;
+    }
+    const int removed = g_activeProfile;
+    SwitchProfile(hwnd, removed > 0 ? removed - 1 : 1);
+    g_profiles.erase(g_profiles.begin() + removed);
+    if (g_activeProfile > removed) {
+        --g_activeProfile;
+    }
+}
+
+/**
+ * @brief Lists the profiles at the top of the tray menu's Profiles submenu,
+ *        checking the active one.
+ */
+void AddProfileMenuItems(HMENU menu) {
+    HMENU profiles = NULL;
+    for (int i = 0; i < GetMenuItemCount(menu) && !profiles; ++i) {
+        HMENU subMenu = GetSubMenu(menu, i);
+        if (subMenu && GetMenuState(subMenu, ID_TRAY_PROFILE_NEW, MF_BYCOMMAND) != (UINT)-1) {
+            profiles = subMenu;
+        }
+    }
+    if (!profiles) {
+        return;
+    }
+    for (size_t i = 0; i < g_profiles.size(); ++i) {
+        const UINT check = (int)i == g_activeProfile ? MF_CHECKED : MF_UNCHECKED;
+        InsertMenu(profiles, (UINT)i, MF_BYPOSITION | MF_STRING | check, ID_TRAY_PROFILE_FIRST + i,
+                   Utf8ToWide(g_profiles[i].name.c_str()).c_str());
+    }
+    InsertMenu(profiles, (UINT)g_profiles.size(), MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
+    EnableMenuItem(profiles, ID_TRAY_PROFILE_NEW,
+                   MF_BYCOMMAND | ((int)g_profiles.size() < SETTINGS_MAX_PROFILES ? MF_ENABLED : MF_GRAYED));
+    EnableMenuItem(profiles, ID_TRAY_PROFILE_DELETE, MF_BYCOMMAND | (g_profiles.size() > 1 ? MF_ENABLED : MF_GRAYED));
+}
+
+//--------------------------------------------------------------------------------------
+// Settings Persistence
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief Converts between UTF-8, used for paths in grid_settings.h, and UTF-16.
+ */
+std::wstring Utf8ToWide(const char* text) {
+    const int length = MultiByteToWideChar(CP_UTF8, 0, text, -1, NULL, 0);
+    std::wstring wide(length > 1 ? length - 1 : 0, L'\0');
+    if (length > 1) {
+        MultiByteToWideChar(CP_UTF8, 0, text, -1, &wide[0], length);
+    }
+    return wide;
+}
+
+std::string WideToUtf8(const wchar_t* text) {
+    const int length = WideCharToMultiByte(CP_UTF8, 0, text, -1, NULL, 0, NULL, NULL);
+    std::string utf8(length > 1 ? length - 1 : 0, '\0');
+    if (length > 1) {
+        WideCharToMultiByte(CP_UTF8, 0, text, -1, &utf8[0], length, NULL, NULL);
+    }
+    return utf8;
+}
+
+/**
+ * @brief FileSettingsStore on the wide-character file APIs, so any profile path
+ *        works, with a rename that replaces the old file and flushes to disk.
+ */
+class Win32FileSettingsStore : public FileSettingsStore {
+public:
+    explicit Win32FileSettingsStore(const std::string& path) : FileSettingsStore(path) {}
+
+protected:
+    FILE* OpenPath(const char* path, bool write) override {
+        return _wfopen(Utf8ToWide(path).c_str(), write ? L"wb" : L"rb");
+    }
+    bool CommitFile(FILE* file) override {
+        return fflush(file) == 0 && _commit(_fileno(file)) == 0;
+    }
+    bool RenamePath(const char* from, const char* to) override {
+        return MoveFileEx(Utf8ToWide(from).c_str(), Utf8ToWide(to).c_str(),
+                          MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+    }
+    void RemovePath(const char* path) override {
+        DeleteFile(Utf8ToWide(path).c_str());
+    }
+};
+
+/**
+ * @brief Keeps the encoded settings in a single registry value. Setting one
+ *        value is atomic, so no temporary copy is needed.
+ */
+class RegistrySettingsStore : public SettingsStore {
+public:
+    bool Read(std::vector<uint8_t>& bytes) override {
+        DWORD size = 0;
+        if (RegGetValue(HKEY_CURRENT_USER, SETTINGS_KEY, L"settings", RRF_RT_REG_BINARY, NULL, NULL, &size) != ERROR_SUCCESS ||
+            size > SETTINGS_MAX_SIZE) {
+            return false;
         }
-        
+        bytes.resize(size);
+        if (RegGetValue(HKEY_CURRENT_USER, SETTINGS_KEY, L"settings", RRF_RT_REG_BINARY, NULL, bytes.data(), &size) != ERROR_SUCCESS) {
+            return false;
+        }
+        bytes.resize(size);
+        return true;
+    }
+
+    bool Write(const std::vector<uint8_t>& bytes) override {
+        HKEY hKey;
+        if (RegCreateKeyEx(HKEY_CURRENT_USER, SETTINGS_KEY, 0, NULL, REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, NULL) != ERROR_SUCCESS) {
+            return false;
+        }
+        const LONG result = RegSetValueEx(hKey, L"settings", 0, REG_BINARY, bytes.data(), (DWORD)bytes.size());
         RegCloseKey(hKey);
+        return result == ERROR_SUCCESS;
+    }
+};
+
+/**
+ * @brief Returns the path of %APPDATA%\SimpleGridOverlay\settings.dat, creating
+ *        the folder, or an empty string if there is no usable folder.
+ */
+std::string GetSettingsFilePath() {
+    wchar_t appData[MAX_PATH];
+    const DWORD length = GetEnvironmentVariable(L"APPDATA", appData, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH) {
+        return std::string();
     }
+    const std::wstring folder = std::wstring(appData) + L"\\SimpleGridOverlay";
+    if (!CreateDirectory(folder.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS) {
+        return std::string();
+    }
+    return WideToUtf8((folder + L"\\settings.dat").c_str());
 }
 
 /**
- * @brief Loads window position and custom dot state from the registry.
+ * @brief The settings file, or the registry when no file location is available.
  */
-void LoadSettings() {
+SettingsStore& GetSettingsStore() {
+    static Win32FileSettingsStore file(GetSettingsFilePath());
+    static RegistrySettingsStore registry;
+    if (file.Path().empty()) {
+        return registry;
+    }
+    return file;
+}
+
+/**
+ * @brief Copies the live layout (window, dot, grid size and marks) into @p layout.
+ */
+void CaptureLayout(LayoutProfile& layout) {
+    if (g_hWnd) {
+        GetWindowRect(g_hWnd, &g_windowRect);
+    }
+    layout.windowLeft = g_windowRect.left;
+    layout.windowTop = g_windowRect.top;
+    layout.windowRight = g_windowRect.right;
+    layout.windowBottom = g_windowRect.bottom;
+    layout.dotSet = g_isDotSet;
+    layout.dot = g_customDot;
+    layout.cols = g_cols;
+    layout.rows = g_rows;
+    layout.cells = g_cells;
+}
+
+/**
+ * @brief Makes @p layout the live one. Only updates state; the caller moves the window.
+ */
+void ApplyLayout(const LayoutProfile& layout) {
+    g_windowRect = { layout.windowLeft, layout.windowTop, layout.windowRight, layout.windowBottom };
+    SetGridDimensions(layout.cols, layout.rows);
+    g_isDotSet = layout.dotSet;
+    SetCustomDot(layout.dot); // After the grid size, which would otherwise rescale it.
+    g_cells = layout.cells;
+    g_hover.col = g_hover.row = -1;
+}
+
+/**
+ * @brief Copies the current state into @p settings.
+ */
+void CaptureSettings(OverlaySettings& settings) {
+    settings.profiles = g_profiles;
+    settings.activeProfile = g_activeProfile;
+    CaptureLayout(settings.profiles[g_activeProfile]);
+    settings.followGame = g_follow.enabled;
+    settings.autoHide = g_autoHide.enabled;
+    settings.unknownRecords = g_unknownSettingsRecords;
+}
+
+/**
+ * @brief Makes @p settings the current state. Called before the window exists.
+ */
+void ApplySettings(const OverlaySettings& settings) {
+    g_profiles = settings.profiles;
+    g_activeProfile = settings.activeProfile;
+    ApplyLayout(g_profiles[g_activeProfile]);
+    g_follow.enabled = settings.followGame;
+    g_autoHide.enabled = settings.autoHide;
+    g_unknownSettingsRecords = settings.unknownRecords;
+}
+
+/**
+ * @brief Reads the registry values written before the settings file existed
+ *        (version 0): the window rectangle and the dot, which were all that
+ *        version saved. Everything else keeps its default.
+ * @return false if there are none.
+ */
+bool LoadLegacySettings(OverlaySettings& settings) {
     HKEY hKey;
-    if (RegOpenKeyEx(HKEY_CURRENT_USER, L"Software\\SimpleGridOverlay", 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
-        DWORD dwSizeRect = sizeof(g_windowRect);
-        RegGetValue(hKey, NULL, L"windowRect", RRF_RT_REG_BINARY, NULL, &g_windowRect, &dwSizeRect);
-        
-        // <<< NEW: Load dot state and position >>>
-        DWORD dwSizeBool = sizeof(g_isDotSet);
-        RegGetValue(hKey, NULL, L"isDotSet", RRF_RT_DWORD, NULL, &g_isDotSet, &dwSizeBool);
-
-        if (g_isDotSet) {
-            DWORD dwSizePoint = sizeof(g_customDot);
-            RegGetValue(hKey, NULL, L"customDot", RRF_RT_REG_BINARY, NULL, &g_customDot, &dwSizePoint);
+    if (RegOpenKeyEx(HKEY_CURRENT_USER, SETTINGS_KEY, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+        return false;
+    }
+    settings.version = 0;
+    LayoutProfile& layout = settings.profiles[0];
+
+    RECT rect;
+    DWORD dwSizeRect = sizeof(rect);
+    if (RegGetValue(hKey, NULL, L"windowRect", RRF_RT_REG_BINARY, NULL, &rect, &dwSizeRect) == ERROR_SUCCESS &&
+        dwSizeRect == sizeof(rect)) {
+        layout.windowLeft = rect.left;
+        layout.windowTop = rect.top;
+        layout.windowRight = rect.right;
+        layout.windowBottom = rect.bottom;
+    }
+
+    // Old versions stored a one-byte bool under REG_DWORD, so accept any size up to a DWORD.
+    DWORD dotSet = 0;
+    DWORD dwSizeDotSet = sizeof(dotSet);
+    if (RegGetValue(hKey, NULL, L"isDotSet", RRF_RT_ANY, NULL, &dotSet, &dwSizeDotSet) == ERROR_SUCCESS) {
+        layout.dotSet = dotSet != 0;
+    }
+    POINT dot = {};
+    DWORD dwSizePoint = sizeof(dot);
+    const bool dotRead = RegGetValue(hKey, NULL, L"customDot", RRF_RT_REG_BINARY, NULL, &dot, &dwSizePoint) == ERROR_SUCCESS &&
+                         dwSizePoint == sizeof(dot);
+
+    // The dot was saved in client pixels of the default grid; place it on that grid.
+    if (layout.dotSet && dotRead) {
+        layout.dot = GridPointFromClient(SettingsLayoutGeometry(layout), dot.x, dot.y);
+    }
+
+    RegCloseKey(hKey);
+    return true;
+}
+
+/**
+ * @brief Writes snapshots from g_settingsWriter until it is stopped and drained.
+ */
+DWORD WINAPI SettingsWriterProc(LPVOID) {
+    SettingsWriter& writer = g_settingsWriter;
+    std::vector<uint8_t> bytes;
+    AcquireSRWLockExclusive(&writer.lock);
+    for (;;) {
+        if (!writer.hasPending) {
+            if (writer.stopping) {
+                break;
+            }
+            SleepConditionVariableSRW(&writer.wake, &writer.lock, INFINITE, 0);
+            continue;
         }
-        
-        RegCloseKey(hKey);
+
+        const ULONGLONG now = GetTickCount64();
+        ULONGLONG due = writer.lastPendingTick + SETTINGS_DEBOUNCE_MS;
+        if (due > writer.firstPendingTick + SETTINGS_MAX_DELAY_MS) {
+            due = writer.firstPendingTick + SETTINGS_MAX_DELAY_MS;
+        }
+        if (!writer.stopping && now < due) {
+            SleepConditionVariableSRW(&writer.wake, &writer.lock, (DWORD)(due - now), 0);
+            continue;
+        }
+
+        bytes.swap(writer.pending);
+        writer.hasPending = false;
+        ReleaseSRWLockExclusive(&writer.lock);
+        const bool ok = GetSettingsStore().Write(bytes);
+        AcquireSRWLockExclusive(&writer.lock);
+        ++writer.writes;
+        if (!ok) {
+            ++writer.failures;
+        }
+    }
+    ReleaseSRWLockExclusive(&writer.lock);
+    return 0;
+}
+
+/**
+ * @brief Starts the settings writer thread. If it can't be started, saves stay synchronous.
+ */
+void StartSettingsWriter() {
+    g_settingsWriter.stopping = false;
+    g_settingsWriter.thread = CreateThread(NULL, 0, SettingsWriterProc, NULL, 0, NULL);
+}
+
+/**
+ * @brief Writes any pending snapshot and stops the writer thread, waiting for
+ *        both. Later saves are written directly.
+ */
+void FlushSettings() {
+    SettingsWriter& writer = g_settingsWriter;
+    if (!writer.thread) {
+        return;
+    }
+    AcquireSRWLockExclusive(&writer.lock);
+    writer.stopping = true;
+    ReleaseSRWLockExclusive(&writer.lock);
+    WakeConditionVariable(&writer.wake);
+    WaitForSingleObject(writer.thread, INFINITE);
+    CloseHandle(writer.thread);
+    writer.thread = NULL;
+}
+
+/**
+ * @brief Snapshots the current state and queues it for the writer thread.
+ */
+void SaveSettings() {
+    OverlaySettings settings;
+    CaptureSettings(settings);
+    std::vector<uint8_t> bytes;
+    SettingsEncode(settings, bytes);
+
+    SettingsWriter& writer = g_settingsWriter;
+    ++writer.snapshots;
+    if (!writer.thread) {
+        ++writer.writes;
+        if (!GetSettingsStore().Write(bytes)) {
+            ++writer.failures;
+        }
+        return;
+    }
+
+    const ULONGLONG now = GetTickCount64();
+    AcquireSRWLockExclusive(&writer.lock);
+    if (!writer.hasPending) {
+        writer.firstPendingTick = now;
+    }
+    writer.pending.swap(bytes); // The older snapshot, if any, is dropped unwritten.
+    writer.hasPending = true;
+    writer.lastPendingTick = now;
+    ReleaseSRWLockExclusive(&writer.lock);
+    WakeConditionVariable(&writer.wake);
+}
+
+/**
+ * @brief Writes how many snapshots were taken and how many reached the store to
+ *        the debugger output. Call after FlushSettings.
+ */
+void ReportSettingsStats() {
+    wchar_t line[128];
+    swprintf(line, 128, L"Grid Overlay: settings %lu snapshots, %lu writes, %lu failed\n",
+             g_settingsWriter.snapshots, g_settingsWriter.writes, g_settingsWriter.failures);
+    OutputDebugString(line);
+}
+
+/**
+ * @brief Loads the settings store. Without one, imports the legacy registry
+ *        values and saves them in the current format straight away. The legacy
+ *        values are left in place for older versions of the overlay.
+ */
+void LoadSettings() {
+    OverlaySettings settings;
+    std::vector<uint8_t> bytes;
+    if (GetSettingsStore().Read(bytes) && SettingsDecode(bytes.data(), bytes.size(), settings)) {
+        ApplySettings(settings);
+    } else if (LoadLegacySettings(settings)) {
+        ApplySettings(settings);
+        SaveSettings();
     }
 }
 
@@ -211,31 +2006,64 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
     switch (uMsg) {
         case WM_CREATE:
             g_hWnd = hwnd;
+            g_dpi = GetWindowDpi(hwnd);
             AddTrayIcon(hwnd);
             SetWindowPos(hwnd, HWND_TOPMOST, g_windowRect.left, g_windowRect.top, g_windowRect.right - g_windowRect.left, g_windowRect.bottom - g_windowRect.top, SWP_SHOWWINDOW);
+            g_foregroundHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, NULL,
+                                               ForegroundEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
             return 0;
 
         // <<< NEW: Handle mouse clicks for the custom dot >>>
         case WM_LBUTTONDOWN:
-            if (g_isResizeMode) {
-                g_customDot.x = LOWORD(lParam);
-                g_customDot.y = HIWORD(lParam);
+            if (g_isResizeMode && (wParam & MK_CONTROL)) {
+                AdvanceCellAt(hwnd, LOWORD(lParam), HIWORD(lParam));
+            } else if (g_isResizeMode) {
+                RECT dirty = {};
+                if (g_isDotSet) dirty = GetDotRect();
+                RECT clientRect;
+                GetClientRect(hwnd, &clientRect);
+                SetCustomDot(GridPointFromClient(GetGridGeometry(clientRect.right, clientRect.bottom),
+                                                 LOWORD(lParam), HIWORD(lParam)));
                 g_isDotSet = true;
-                InvalidateRect(hwnd, NULL, TRUE); // Force repaint to show the dot
+                RECT newDot = GetDotRect();
+                UnionRect(&dirty, &dirty, &newDot);
+                InvalidateGridRect(hwnd, dirty); // Repaint only where the dot was and is
             }
             return 0;
 
         case WM_RBUTTONDOWN:
-            if (g_isResizeMode) {
+            if (g_isResizeMode && g_isDotSet) {
+                RECT dirty = GetDotRect();
                 g_isDotSet = false;
-                InvalidateRect(hwnd, NULL, TRUE); // Force repaint to remove the dot
+                InvalidateGridRect(hwnd, dirty); // Repaint only where the dot was
+            }
+            return 0;
+
+        case WM_MOUSEMOVE:
+            if (g_isResizeMode) {
+                UpdateHover(hwnd, LOWORD(lParam), HIWORD(lParam));
             }
             return 0;
 
+        case WM_MOUSELEAVE:
+            g_hover.tracking = false;
+            SetHoverCell(hwnd, -1, -1);
+            return 0;
+
         case WM_HOTKEY: 
             if (wParam == RESIZE_HOTKEY_ID) {
                 if (g_isResizeMode) ExitResizeMode(hwnd);
                 else EnterResizeMode(hwnd);
+            } else if (wParam == CELL_HOTKEY_ID) {
+                // The locked overlay is click-through, so mark the cell under the cursor.
+                POINT pt;
+                GetCursorPos(&pt);
+                ScreenToClient(hwnd, &pt);
+                AdvanceCellAt(hwnd, pt.x, pt.y);
+            } else if (wParam == PROFILE_HOTKEY_ID) {
+                if (SwitchProfile(hwnd, (g_activeProfile + 1) % (int)g_profiles.size())) {
+                    SaveSettings();
+                }
             }
             return 0;
 
@@ -248,20 +2076,78 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         case WM_PAINT: {
             PAINTSTRUCT ps;
             HDC hdc = BeginPaint(hwnd, &ps);
-            COLORREF bgColor = g_isResizeMode ? GetSysColor(COLOR_3DFACE) : TRANSPARENT_COLOR;
-            HBRUSH bgBrush = CreateSolidBrush(bgColor);
-            FillRect(hdc, &ps.rcPaint, bgBrush);
-            DeleteObject(bgBrush);
-            DrawGrid(hdc);
+            PaintFromBackBuffer(hwnd, hdc, ps.rcPaint);
             EndPaint(hwnd, &ps);
+            if (g_liveResize.active) {
+                RecordLiveResizeFrame();
+                DwmFlush(); // Hold the next frame until the compositor has shown this one.
+            }
+            return 0;
+        }
+
+        case WM_ENTERSIZEMOVE:
+            g_liveResize = LiveResize();
+            g_liveResize.active = true;
+            return 0;
+
+        case WM_EXITSIZEMOVE:
+            g_liveResize.active = false;
+            ReportLiveResizeFrames();
+            return 0;
+
+        case WM_SIZE:
+            GridGeometryUpdate(g_geometry, LOWORD(lParam), HIWORD(lParam), g_cols, g_rows);
+            InvalidateGrid(hwnd);
+            UpdateAnimation(hwnd); // Minimizing stops the blink.
+            return 0;
+
+        case WM_APP_FOLLOW:
+            ApplyFollow(hwnd);
+            return 0;
+
+        case WM_APP_TARGET_EXITED:
+            if ((DWORD)wParam == g_autoHide.processId) {
+                ClearAutoHideTarget(); // The next eligible foreground window becomes the game.
+                UpdateAutoHide(hwnd);
+                UpdateAnimation(hwnd);
+            }
+            return 0;
+
+        case WM_TIMER:
+            if (wParam == BLINK_TIMER_ID) {
+                OnBlinkTimer(hwnd);
+            }
+            return 0;
+
+        case WM_DPICHANGED: {
+            // The dot is in grid space, so it follows the rescaled grid by itself.
+            g_dpi = HIWORD(wParam);
+
+            const RECT* suggested = (const RECT*)lParam;
+            SetWindowPos(hwnd, NULL, suggested->left, suggested->top,
+                         suggested->right - suggested->left, suggested->bottom - suggested->top,
+                         SWP_NOZORDER | SWP_NOACTIVATE);
+            InvalidateGrid(hwnd);
             return 0;
         }
 
+        case WM_SYSCOLORCHANGE:
+            InvalidateGrid(hwnd);
+            return 0;
+
+        case WM_ERASEBKGND:
+            return 1; // The back buffer covers every pixel; erasing would only flicker.
+
         case WM_APP_TRAY_MSG:
             if (lParam == WM_RBUTTONUP || lParam == WM_LBUTTONUP) {
                 HMENU hMenu = LoadMenu(g_hInstance, MAKEINTRESOURCE(IDR_TRAYMENU));
                 if (hMenu) {
                     HMENU hSubMenu = GetSubMenu(hMenu, 0);
+                    CheckMenuItem(hSubMenu, ID_TRAY_GRID_10X6, MF_BYCOMMAND | ((g_cols == 10 && g_rows == 6) ? MF_CHECKED : MF_UNCHECKED));
+                    CheckMenuItem(hSubMenu, ID_TRAY_AUTOHIDE, MF_BYCOMMAND | (g_autoHide.enabled ? MF_CHECKED : MF_UNCHECKED));
+                    CheckMenuItem(hSubMenu, ID_TRAY_FOLLOW, MF_BYCOMMAND | (g_follow.enabled ? MF_CHECKED : MF_UNCHECKED));
+                    CheckMenuItem(hSubMenu, ID_TRAY_GRID_6X5, MF_BYCOMMAND | ((g_cols == 6 && g_rows == 5) ? MF_CHECKED : MF_UNCHECKED));
+                    AddProfileMenuItems(hSubMenu);
                     POINT pt;
                     GetCursorPos(&pt);
                     SetForegroundWindow(hwnd);
@@ -281,13 +2167,67 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                     if (g_isResizeMode) ExitResizeMode(hwnd);
                     else EnterResizeMode(hwnd);
                     break;
+                case ID_TRAY_FOLLOW:
+                    g_follow.enabled = !g_follow.enabled;
+                    if (g_follow.enabled) StartFollowing(hwnd, GetWindowBeneath(hwnd));
+                    else StopFollowing();
+                    SetAutoHideTarget(g_follow.target);
+                    SaveSettings();
+                    break;
+                case ID_TRAY_AUTOHIDE:
+                    g_autoHide.enabled = !g_autoHide.enabled;
+                    UpdateAutoHide(hwnd);
+                    SaveSettings();
+                    break;
+                case ID_TRAY_GRID_10X6:
+                case ID_TRAY_GRID_6X5:
+                    if (LOWORD(wParam) == ID_TRAY_GRID_10X6) SetGridDimensions(10, 6);
+                    else SetGridDimensions(6, 5);
+                    InvalidateGrid(hwnd);
+                    UpdateAnimation(hwnd);
+                    SaveSettings();
+                    break;
+                case ID_TRAY_PROFILE_NEW:
+                    if (AddProfile(hwnd, NewProfileName())) SaveSettings();
+                    break;
+                case ID_TRAY_PROFILE_DELETE:
+                    DeleteActiveProfile(hwnd);
+                    SaveSettings();
+                    break;
+                default:
+                    if (LOWORD(wParam) >= ID_TRAY_PROFILE_FIRST && LOWORD(wParam) < ID_TRAY_PROFILE_FIRST + SETTINGS_MAX_PROFILES &&
+                        SwitchProfile(hwnd, LOWORD(wParam) - ID_TRAY_PROFILE_FIRST)) {
+                        SaveSettings();
+                    }
+                    break;
+            }
+            return 0;
+
+        case WM_ENDSESSION:
+            // The process may be ended as soon as this returns, without a WM_DESTROY.
+            if (wParam) {
+                SaveSettings();
+                FlushSettings();
             }
             return 0;
 
         case WM_DESTROY:
             RemoveTrayIcon(hwnd);
             UnregisterHotKey(hwnd, RESIZE_HOTKEY_ID); 
+            UnregisterHotKey(hwnd, CELL_HOTKEY_ID);
+            UnregisterHotKey(hwnd, PROFILE_HOTKEY_ID);
             SaveSettings();
+            FlushSettings();
+            ReportSettingsStats();
+            ReportRenderStats();
+            ReportAnimationStats();
+            ReportFollowStats();
+            StopFollowing();
+            ClearAutoHideTarget();
+            if (g_animation.timer) KillTimer(hwnd, BLINK_TIMER_ID);
+            if (g_foregroundHook) UnhookWinEvent(g_foregroundHook);
+            DestroyBackBuffer();
+            DestroyRenderCache();
             PostQuitMessage(0);
             return 0;
     }
@@ -299,7 +2239,47 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
  */
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow) {
     g_hInstance = hInstance;
+    EnablePerMonitorDpiAwareness();
+    // Options are whole arguments; a value with spaces is quoted, e.g. /profile "Bag 2".
+    bool alpha = false;
+    std::wstring profileName, gridSize, renderPath;
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    for (int i = 1; argv && i < argc; ++i) { // argv[0] is the program.
+        const bool hasValue = i + 1 < argc;
+        if (wcscmp(argv[i], L"/alpha") == 0) {
+            alpha = true;
+        } else if (wcscmp(argv[i], L"/profile") == 0 && hasValue) {
+            profileName = argv[++i];
+        } else if (wcscmp(argv[i], L"/grid") == 0 && hasValue) {
+            gridSize = argv[++i];
+        } else if (wcscmp(argv[i], L"/render") == 0 && hasValue) {
+            renderPath = argv[++i];
+        }
+    }
+    if (argv) LocalFree(argv);
+
+    if (alpha) {
+        g_presentMode = PRESENT_PER_PIXEL_ALPHA;
+    }
     LoadSettings();
+    if (!profileName.empty() && SelectProfileByName(WideToUtf8(profileName.c_str()))) {
+        SaveSettings();
+    }
+    if (!gridSize.empty()) {
+        int cols = 0, rows = 0;
+        wchar_t extra = 0;
+        if (swscanf(gridSize.c_str(), L"%dx%d%lc", &cols, &rows, &extra) == 2) {
+            SetGridDimensions(cols, rows);
+        }
+    }
+
+    // Headless mode: render the saved layout to an image and exit without showing a window.
+    if (!renderPath.empty()) {
+        return RenderToFile(renderPath.c_str()) ? 0 : 1;
+    }
+
+    StartSettingsWriter();
 
     WNDCLASSEX wc = {};
     wc.cbSize = sizeof(WNDCLASSEX);
@@ -320,9 +2300,25 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
     if (hWnd == NULL) return 0;
     
     RegisterHotKey(hWnd, RESIZE_HOTKEY_ID, MOD_CONTROL | MOD_ALT, 'G');
-    SetLayeredWindowAttributes(hWnd, TRANSPARENT_COLOR, 0, LWA_COLORKEY);
+    RegisterHotKey(hWnd, CELL_HOTKEY_ID, MOD_CONTROL | MOD_ALT, 'N');
+    RegisterHotKey(hWnd, PROFILE_HOTKEY_ID, MOD_CONTROL | MOD_ALT, 'P');
     ShowWindow(hWnd, nCmdShow);
+    if (g_presentMode == PRESENT_PER_PIXEL_ALPHA && !PresentLayered(hWnd)) {
+        // UpdateLayeredWindow was refused; fall back to the color-key path.
+        g_presentMode = PRESENT_COLOR_KEY;
+        DestroyRenderCache(); // Drop the anti-aliased font; its fringes would show against the color key.
+        ++g_gridGeneration;
+    }
+    if (g_presentMode == PRESENT_COLOR_KEY) {
+        SetLayeredWindowAttributes(hWnd, TRANSPARENT_COLOR, 0, LWA_COLORKEY);
+    }
     UpdateWindow(hWnd);
+    if (g_follow.enabled) {
+        StartFollowing(hWnd, GetWindowBeneath(hWnd));
+    }
+    SetAutoHideTarget(g_follow.target);
+    UpdateAutoHide(hWnd);
+    UpdateAnimation(hWnd);
 
     MSG msg = {};
     while (GetMessage(&msg, NULL, 0, 0) > 0) {
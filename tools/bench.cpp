@@ -0,0 +1,466 @@
+/**
+ * @file bench.cpp
+ * @brief Micro-benchmarks for the renderer, one section per subsystem.
+ *
+ *     bench [SECTION...]
+ *
+ * Runs every section, or only the named ones. Times are per frame (or per
+ * operation) in microseconds, reported as p50/p99 over many repetitions.
+ * Sections that compare against GDI only run that half on Windows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "grid_plan.h"
+#include "test_scene.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include "grid_render_gdi.h"
+#endif
+
+//--------------------------------------------------------------------------------------
+// Timing
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief p50 and p99 of a set of timings, in microseconds.
+ */
+struct BenchResult {
+    double p50;
+    double p99;
+};
+
+/**
+ * @brief Runs @p fn @p iterations times after a short warm-up and returns its
+ *        median and 99th percentile.
+ */
+template <class Fn>
+BenchResult BenchRun(int iterations, Fn fn) {
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        fn(i);
+    }
+    std::vector<double> times(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn(i);
+        times[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::sort(times.begin(), times.end());
+    BenchResult result = { times[times.size() / 2], times[std::min(times.size() - 1, times.size() * 99 / 100)] };
+    return result;
+}
+
+void BenchPrint(const char* name, const BenchResult& result) {
+    printf("  %-44s p50 %10.2f us   p99 %10.2f us\n", name, result.p50, result.p99);
+}
+
+/**
+ * @brief Prints a timing as throughput: @p pixels touched per run, in megapixels per second.
+ */
+void BenchPrintRate(const char* name, const BenchResult& result, double pixels) {
+    printf("  %-44s p50 %10.2f us   %8.0f MP/s\n", name, result.p50, pixels / result.p50);
+}
+
+/**
+ * @brief A cleared surface that owns its pixels.
+ */
+struct BenchSurface {
+    std::vector<uint32_t> pixels;
+    RasterSurface surface;
+
+    BenchSurface(int width, int height) : pixels((size_t)width * height, 0) {
+        surface = RasterMakeSurface(pixels.data(), width, height, width);
+    }
+};
+
+#ifdef _WIN32
+/**
+ * @brief A 32-bit DIB section selected into a memory DC, for timing GDI paths.
+ */
+struct BenchGdiSurface {
+    HDC dc;
+    HBITMAP bitmap;
+    HGDIOBJ old;
+
+    BenchGdiSurface(int width, int height) {
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+        bmi.bmiHeader.biWidth = width;
+        bmi.bmiHeader.biHeight = -height;
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+        void* bits = NULL;
+        dc = CreateCompatibleDC(NULL);
+        bitmap = CreateDIBSection(dc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+        old = SelectObject(dc, bitmap);
+    }
+    ~BenchGdiSurface() {
+        SelectObject(dc, old);
+        DeleteObject(bitmap);
+        DeleteDC(dc);
+    }
+};
+
+/**
+ * @brief The labels as the overlay drew them before the atlas: a new Arial font
+ *        and one DrawText call per column, every frame.
+ */
+void BenchDrawTextLabels(HDC dc, const GridGeometry& geometry, int fontHeight) {
+    HFONT font = CreateFontW(fontHeight, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS,
+                             CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH | FF_SWISS, L"Arial");
+    HGDIOBJ oldFont = SelectObject(dc, font);
+    SetBkMode(dc, TRANSPARENT);
+    SetTextColor(dc, RGB(192, 192, 192));
+    for (int i = 0; i < geometry.cols; ++i) {
+        wchar_t text[4];
+        swprintf(text, 4, L"%d", i + 1);
+        RECT rc = { geometry.colEdge[i], 0, geometry.colEdge[i + 1], geometry.rowEdge[1] };
+        DrawTextW(dc, text, -1, &rc, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+    }
+    SelectObject(dc, oldFont);
+    DeleteObject(font);
+}
+#endif
+
+/**
+ * @brief Draws the column labels of @p geometry with the atlas, as RenderPlanReplay would.
+ */
+void BenchAtlasLabels(RasterSurface& surface, const GlyphAtlas& atlas, GlyphStrip& strip, const GridGeometry& geometry,
+                      int fontHeight, bool antialias) {
+    for (int i = 0; i < geometry.cols; ++i) {
+        char text[12];
+        snprintf(text, sizeof(text), "%d", i + 1);
+        RasterDrawGlyphTextCentered(surface, atlas, strip, text, fontHeight, geometry.colEdge[i], 0,
+                                    geometry.colEdge[i + 1], geometry.rowEdge[1], 0xFFC0C0C0, antialias);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Sections
+//--------------------------------------------------------------------------------------
+
+GlyphAtlas g_atlas;
+GlyphStrip g_strip; // g_atlas resampled at the last label height drawn.
+
+/**
+ * @brief Digit atlas blits against per-frame DrawText, for the ten labels of a
+ *        PC box at 1080p and 4K cell sizes.
+ */
+void BenchLabels() {
+    const struct { const char* name; int width; int height; } sizes[] = {
+        { "1080p (64 px cells)", 640, 384 },
+        { "4K (128 px cells)", 1280, 768 },
+    };
+    for (const auto& size : sizes) {
+        printf(" %s\n", size.name);
+        GridGeometry geometry;
+        GridGeometryUpdate(geometry, size.width, size.height, 10, 6);
+        const int fontHeight = geometry.rowEdge[1] * 3 / 5;
+        BenchSurface target(size.width, size.height);
+        BenchPrint("atlas, crisp", BenchRun(2000, [&](int) {
+            BenchAtlasLabels(target.surface, g_atlas, g_strip, geometry, fontHeight, false);
+        }));
+        BenchPrint("atlas, anti-aliased", BenchRun(2000, [&](int) {
+            BenchAtlasLabels(target.surface, g_atlas, g_strip, geometry, fontHeight, true);
+        }));
+#ifdef _WIN32
+        BenchGdiSurface gdi(size.width, size.height);
+        BenchPrint("DrawText with a new font", BenchRun(2000, [&](int) {
+            BenchDrawTextLabels(gdi.dc, geometry, fontHeight);
+        }));
+#else
+        printf("  %-44s (Windows only)\n", "DrawText with a new font");
+#endif
+    }
+}
+
+/**
+ * @brief Edge tables and grid lines for one grid size. The edge tables are
+ *        rebuilt at alternating widths, as during a live resize.
+ */
+void BenchGridSize(int width, int height, int cols, int rows) {
+    printf(" %dx%d at %dx%d\n", cols, rows, width, height);
+    GridGeometry geometry;
+    int sink = 0;
+    BenchPrint("edge tables x1000", BenchRun(200, [&](int) {
+        for (int i = 0; i < 1000; ++i) {
+            GridGeometryUpdate(geometry, width - (i & 1), height, cols, rows);
+            sink += geometry.colEdge[cols / 2];
+        }
+    }));
+    GridGeometryUpdate(geometry, width, height, cols, rows);
+    BenchSurface target(width, height);
+    BenchPrint("grid lines", BenchRun(2000, [&](int) {
+        RasterDrawGridLines(target.surface, geometry, 1, 0xFF8A2BE2, false);
+    }));
+    BenchPrint("grid lines AA", BenchRun(2000, [&](int) {
+        RasterDrawGridLines(target.surface, geometry, 1, 0xFF8A2BE2, true);
+    }));
+    if (sink == 42) {
+        printf("\n"); // Keeps the edge-table loop from being optimized away.
+    }
+}
+
+/**
+ * @brief Times full frames through the render plan, recompiled every frame.
+ */
+void BenchGridFrame(int width, int height, int cols, int rows) {
+    GridGeometry geometry;
+    GridGeometryUpdate(geometry, width, height, cols, rows);
+    const GridScene scene = TestSceneBuild(geometry, TEST_MODE_ALPHA, 1, &g_atlas, &g_strip, NULL, false);
+    RenderPlan plan;
+    MemoryBackend backend;
+    char name[64];
+    snprintf(name, sizeof(name), "frame %dx%d", cols, rows);
+    BenchPrint(name, BenchRun(500, [&](int) {
+        RenderPlanBuild(plan, scene);
+        RenderPlanReplay(plan, backend);
+    }));
+}
+
+/**
+ * @brief The anti-aliased 10x6 grid plus the dot and its halo at 4K and 200%
+ *        scale, drawn the way RenderPlanReplay draws them, with and without
+ *        clearing the surface first. Marks, labels and the hover highlight are
+ *        left out.
+ */
+void BenchAntialiasFrame4K() {
+    const int width = 3840, height = 2160, scale = 2;
+    printf(" 10x6 grid and markers, anti-aliased, at %dx%d\n", width, height);
+    GridGeometry geometry;
+    GridGeometryUpdate(geometry, width, height, 10, 6);
+    const GridScene scene = TestSceneBuild(geometry, TEST_MODE_ALPHA, scale, NULL, NULL, NULL, true);
+    BenchSurface target(width, height);
+    auto draw = [&]() {
+        RasterDrawGridLines(target.surface, geometry, scene.lineWidth, scene.gridColor, true);
+        RasterFillCircleAA(target.surface, scene.dotX, scene.dotY, scene.dotHaloRadius, scene.dotHaloColor);
+        RasterFillCircleAA(target.surface, scene.dotX, scene.dotY, scene.dotRadius, scene.dotColor);
+    };
+    BenchPrint("grid lines and markers", BenchRun(500, [&](int) {
+        draw();
+    }));
+    BenchPrint("cleared, then grid lines and markers", BenchRun(200, [&](int) {
+        RasterClear(target.surface, scene.background);
+        draw();
+    }));
+}
+
+void BenchGrids() {
+    BenchGridSize(640, 384, 10, 6);
+    BenchGridSize(384, 320, 6, 5);
+    BenchGridSize(640, 384, 64, 64);
+    printf(" frames at 640x384\n");
+    BenchGridFrame(640, 384, 10, 6);
+    BenchGridFrame(640, 384, 6, 5);
+    BenchGridFrame(640, 384, 64, 64);
+    BenchAntialiasFrame4K();
+}
+
+#ifdef _WIN32
+/**
+ * @brief Label fonts by height for the GDI backend, created on first use like run.cpp's.
+ */
+HFONT BenchLabelFont(int fontHeight) {
+    static HFONT fonts[512] = {};
+    const int slot = fontHeight < 0 ? 0 : (fontHeight > 511 ? 511 : fontHeight);
+    if (!fonts[slot]) {
+        fonts[slot] = CreateFontW(fontHeight, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS,
+                                  CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH | FF_SWISS, L"Arial");
+    }
+    return fonts[slot];
+}
+#endif
+
+/**
+ * @brief The same scene through every backend: the software rasterizer into a
+ *        caller-owned surface, the headless memory backend, and GDI on Windows.
+ *        Plans are compiled once, so this is the cost of replaying a frame.
+ */
+void BenchBackends() {
+    const struct { const char* name; int width; int height; } sizes[] = {
+        { "1080p box", 640, 384 },
+        { "4K box", 1280, 768 },
+    };
+    for (const auto& size : sizes) {
+        GridGeometry geometry;
+        GridGeometryUpdate(geometry, size.width, size.height, 10, 6);
+        CellStates cells;
+        TestCellsMark(cells, geometry);
+        for (int mode = TEST_MODE_COLOR_KEY; mode <= TEST_MODE_ALPHA; ++mode) {
+            printf(" %s, %s\n", size.name, TEST_MODE_NAMES[mode]);
+            const GridScene scene = TestSceneBuild(geometry, (TestMode)mode, 1, &g_atlas, &g_strip, &cells, true);
+            RenderPlan plan;
+            RenderPlanBuild(plan, scene);
+
+            BenchSurface target(size.width, size.height);
+            RasterBackend raster(target.surface);
+            BenchPrint("raster", BenchRun(500, [&](int) { RenderPlanReplay(plan, raster); }));
+
+            MemoryBackend memory;
+            BenchPrint("memory", BenchRun(500, [&](int) { RenderPlanReplay(plan, memory); }));
+#ifdef _WIN32
+            BenchGdiSurface gdi(size.width, size.height);
+            HPEN pen = CreatePen(PS_SOLID, 1, RGB(138, 43, 226));
+            RECT clip = { 0, 0, size.width, size.height };
+            GdiBackend gdiBackend(gdi.dc, clip, pen, BenchLabelFont);
+            BenchPrint("gdi", BenchRun(500, [&](int) { RenderPlanReplay(plan, gdiBackend); }));
+            DeleteObject(pen);
+#else
+            printf("  %-44s (Windows only)\n", "gdi");
+#endif
+        }
+    }
+}
+
+/**
+ * @brief Times one span kernel over every row of the surface.
+ */
+BenchResult BenchSpanKernel(BenchSurface& target, RasterSpanFillFn kernel, uint32_t color) {
+    return BenchRun(100, [&](int) {
+        for (int y = 0; y < target.surface.height; ++y) {
+            kernel(target.surface.pixels + (intptr_t)y * target.surface.stride, target.surface.width, color);
+        }
+    });
+}
+
+/**
+ * @brief Premultiplied blend throughput for whole 1080p and 4K overlays: each span
+ *        kernel on its own, then the rectangle and circle fills that use them.
+ */
+void BenchBlend() {
+    const struct { const char* name; int width; int height; } sizes[] = {
+        { "1080p", 1920, 1080 },
+        { "4K", 3840, 2160 },
+    };
+    const uint32_t translucent = RasterArgb(96, 255, 215, 0);
+    for (const auto& size : sizes) {
+        printf(" %s (%dx%d)\n", size.name, size.width, size.height);
+        BenchSurface target(size.width, size.height);
+        const double pixels = (double)size.width * size.height;
+        BenchPrintRate("blend span, scalar", BenchSpanKernel(target, RasterBlendSpanScalar, translucent), pixels);
+#if defined(GRID_RASTER_SSE2)
+        BenchPrintRate("blend span, SSE2", BenchSpanKernel(target, RasterBlendSpanSse2, translucent), pixels);
+#endif
+#if defined(GRID_RASTER_AVX2)
+        if (__builtin_cpu_supports("avx2")) {
+            BenchPrintRate("blend span, AVX2", BenchSpanKernel(target, RasterBlendSpanAvx2, translucent), pixels);
+        }
+#endif
+        BenchPrintRate("blend span, dispatched", BenchSpanKernel(target, RasterBlendSpan, translucent), pixels);
+        BenchPrintRate("fill span, dispatched", BenchSpanKernel(target, RasterFillSpan, 0xFF000001), pixels);
+        BenchPrintRate("RasterBlendRect, whole surface", BenchRun(100, [&](int) {
+            RasterBlendRect(target.surface, 0, 0, size.width, size.height, translucent);
+        }), pixels);
+
+        // Cell-sized fills, as the marks of a 10x6 box covering the screen.
+        GridGeometry geometry;
+        GridGeometryUpdate(geometry, size.width, size.height, 10, 6);
+        BenchPrintRate("RasterBlendRect, 60 cells", BenchRun(100, [&](int) {
+            for (int row = 0; row < geometry.rows; ++row) {
+                for (int col = 0; col < geometry.cols; ++col) {
+                    RasterBlendRect(target.surface, geometry.colEdge[col], geometry.rowEdge[row], geometry.colEdge[col + 1],
+                                    geometry.rowEdge[row + 1], translucent);
+                }
+            }
+        }), pixels);
+
+        const int r = size.height / 4;
+        const double circle = 3.14159265 * r * r;
+        BenchPrintRate("RasterFillCircle, translucent", BenchRun(200, [&](int) {
+            RasterFillCircle(target.surface, size.width / 2, size.height / 2, r, translucent);
+        }), circle);
+        BenchPrintRate("RasterFillCircleAA, translucent", BenchRun(200, [&](int) {
+            RasterFillCircleAA(target.surface, size.width / 2, size.height / 2, r, translucent);
+        }), circle);
+    }
+}
+
+/**
+ * @brief Labels during a simulated live resize: the box grows from 320x192 to
+ *        1920x1152 a few pixels per frame, so the label height changes on most
+ *        frames and the atlas strip is resampled each time. Steady-state blits
+ *        at one size are shown for reference.
+ */
+void BenchResize() {
+    const int steps = 400;
+    std::vector<GridGeometry> sweep(steps);
+    for (int i = 0; i < steps; ++i) {
+        GridGeometryUpdate(sweep[i], 320 + i * 4, 192 + i * 24 / 10, 10, 6);
+    }
+    BenchSurface target(1920, 1152);
+    for (int antialias = 0; antialias < 2; ++antialias) {
+        BenchPrint(antialias ? "atlas sweep, anti-aliased" : "atlas sweep, crisp", BenchRun(steps, [&](int i) {
+            const GridGeometry& geometry = sweep[i % steps];
+            BenchAtlasLabels(target.surface, g_atlas, g_strip, geometry, geometry.rowEdge[1] * 3 / 5, antialias != 0);
+        }));
+        BenchPrint(antialias ? "strip resample only, anti-aliased" : "strip resample only, crisp", BenchRun(steps, [&](int i) {
+            const GridGeometry& geometry = sweep[i % steps];
+            // The height alternates, so the strip is never reused.
+            GlyphAtlasStrip(g_strip, g_atlas, geometry.rowEdge[1] * 3 / 5 + (i & 1), antialias != 0);
+        }));
+        const GridGeometry& middle = sweep[steps / 2];
+        BenchPrint(antialias ? "atlas at one size, anti-aliased" : "atlas at one size, crisp", BenchRun(steps, [&](int) {
+            BenchAtlasLabels(target.surface, g_atlas, g_strip, middle, middle.rowEdge[1] * 3 / 5, antialias != 0);
+        }));
+    }
+#ifdef _WIN32
+    BenchGdiSurface gdi(1920, 1152);
+    BenchPrint("DrawText sweep, new font per frame", BenchRun(steps, [&](int i) {
+        const GridGeometry& geometry = sweep[i % steps];
+        BenchDrawTextLabels(gdi.dc, geometry, geometry.rowEdge[1] * 3 / 5);
+    }));
+#else
+    printf("  %-44s (Windows only)\n", "DrawText sweep, new font per frame");
+#endif
+}
+
+/**
+ * @brief A named benchmark section.
+ */
+struct BenchSection {
+    const char* name;
+    void (*run)();
+};
+
+const BenchSection BENCH_SECTIONS[] = {
+    { "labels", BenchLabels },
+    { "grids", BenchGrids },
+    { "backends", BenchBackends },
+    { "blend", BenchBlend },
+    { "resize", BenchResize },
+};
+
+//--------------------------------------------------------------------------------------
+// Main
+//--------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    TestAtlasBuild(g_atlas);
+    int ran = 0;
+    for (const BenchSection& section : BENCH_SECTIONS) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || strcmp(argv[i], section.name) == 0;
+        }
+        if (selected) {
+            printf("[%s]\n", section.name);
+            section.run();
+            ++ran;
+        }
+    }
+    if (ran == 0) {
+        fprintf(stderr, "usage: %s [SECTION...]\nsections:", argv[0]);
+        for (const BenchSection& section : BENCH_SECTIONS) {
+            fprintf(stderr, " %s", section.name);
+        }
+        fprintf(stderr, "\n");
+        return 2;
+    }
+    return 0;
+}
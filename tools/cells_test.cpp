@@ -0,0 +1,188 @@
+/**
+ * @file cells_test.cpp
+ * @brief Unit tests for the packed cell marks: lookup across word boundaries
+ *        and the saved byte layout.
+ *
+ *     cells_test
+ *
+ * Exits non-zero if any check fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "grid_cells.h"
+
+int g_failures = 0;
+
+#define CHECK(condition)                                                      \
+    do {                                                                      \
+        if (!(condition)) {                                                   \
+            printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            ++g_failures;                                                     \
+        }                                                                     \
+    } while (0)
+
+// Cell counts that end on, just before and just after a word or byte boundary,
+// plus the common grids and the largest one.
+const int TEST_CELL_COUNTS[] = { 1, 3, 4, 5, 30, 31, 32, 33, 60, 63, 64, 65, 96, 97, CELL_MAX_COUNT - 1, CELL_MAX_COUNT };
+
+//--------------------------------------------------------------------------------------
+// Helpers
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief Small xorshift generator, so every run marks the same cells.
+ */
+uint32_t TestRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * @brief The first of the first @p cellCount cells in @p state, one cell at a time.
+ */
+int TestFindFirstSlow(const CellStates& states, int cellCount, CellState state) {
+    for (int i = 0; i < cellCount; ++i) {
+        if (CellStatesGet(states, i) == state) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//--------------------------------------------------------------------------------------
+// Tests
+//--------------------------------------------------------------------------------------
+
+void TestFindFirstBoundaries() {
+    for (int cellCount : TEST_CELL_COUNTS) {
+        const int candidates[] = { 0, 31, 32, 63, 64, cellCount - 1 };
+        for (int index : candidates) {
+            if (index < 0 || index >= cellCount) {
+                continue;
+            }
+            for (int s = CELL_EGG; s < CELL_STATE_COUNT; ++s) {
+                const CellState state = (CellState)s;
+                CellStates states;
+                CellStatesSet(states, index, state);
+                CHECK(CellStatesFindFirst(states, cellCount, state) == index);
+                CHECK(CellStatesFindFirst(states, cellCount, (CellState)(s % (CELL_STATE_COUNT - 1) + 1)) == -1);
+                CHECK(CellStatesFindFirst(states, cellCount, CELL_EMPTY) == (index == 0 ? (cellCount > 1 ? 1 : -1) : 0));
+
+                // Everything else marked: the only empty cell is found.
+                CellStates full;
+                for (int i = 0; i < cellCount; ++i) {
+                    CellStatesSet(full, i, i == index ? CELL_EMPTY : state);
+                }
+                CHECK(CellStatesFindFirst(full, cellCount, CELL_EMPTY) == index);
+            }
+        }
+
+        // A mark just past the end is not part of the grid.
+        if (cellCount < CELL_MAX_COUNT) {
+            CellStates states;
+            CellStatesSet(states, cellCount, CELL_EGG);
+            CHECK(CellStatesFindFirst(states, cellCount, CELL_EGG) == -1);
+        }
+    }
+}
+
+void TestFindFirstRandom() {
+    uint32_t seed = 12345;
+    for (int cellCount : TEST_CELL_COUNTS) {
+        for (int round = 0; round < 50; ++round) {
+            // Sparse marks, so the first match is often words away.
+            CellStates states;
+            for (int i = 0; i < cellCount + 40 && i < CELL_MAX_COUNT; ++i) {
+                if (TestRandom(seed) % 97 == 0) {
+                    CellStatesSet(states, i, (CellState)(1 + TestRandom(seed) % 3));
+                }
+            }
+            for (int s = 0; s < CELL_STATE_COUNT; ++s) {
+                CHECK(CellStatesFindFirst(states, cellCount, (CellState)s) == TestFindFirstSlow(states, cellCount, (CellState)s));
+            }
+        }
+    }
+}
+
+void TestSaveLoad() {
+    uint32_t seed = 777;
+    for (int cellCount : TEST_CELL_COUNTS) {
+        CellStates states;
+        for (int i = 0; i < CELL_MAX_COUNT; ++i) {
+            CellStatesSet(states, i, (CellState)(TestRandom(seed) % 4)); // Past cellCount too.
+        }
+        const int byteCount = CellStatesByteCount(cellCount);
+        CHECK(byteCount == (cellCount + 3) / 4);
+        std::vector<uint8_t> bytes(byteCount);
+        CellStatesSave(states, cellCount, bytes.data());
+        if (cellCount % 4 != 0) {
+            CHECK((bytes[byteCount - 1] >> (2 * (cellCount % 4))) == 0); // Nothing saved past the end.
+        }
+
+        CellStates loaded;
+        CellStatesSet(loaded, CELL_MAX_COUNT - 1, CELL_FLAGGED); // Must be cleared by the load.
+        CellStatesLoad(loaded, cellCount, bytes.data());
+        int marked = 0;
+        bool same = true;
+        for (int i = 0; i < CELL_MAX_COUNT; ++i) {
+            const CellState expected = i < cellCount ? CellStatesGet(states, i) : CELL_EMPTY;
+            same = same && CellStatesGet(loaded, i) == expected;
+            marked += expected != CELL_EMPTY;
+        }
+        CHECK(same);
+        CHECK(loaded.marked == marked);
+
+        // The cell-by-cell layout: cell i in bits 2 * (i % 4) of byte i / 4.
+        bool layout = true;
+        for (int i = 0; i < cellCount; ++i) {
+            layout = layout && ((bytes[i / 4] >> (2 * (i % 4))) & 3) == CellStatesGet(states, i);
+        }
+        CHECK(layout);
+    }
+}
+
+void TestLoadIgnoresExtraBits() {
+    // A damaged or hand-edited blob with every bit set: cells past the count in
+    // the last byte are ignored instead of being marked or counted.
+    for (int cellCount : TEST_CELL_COUNTS) {
+        std::vector<uint8_t> bytes(CellStatesByteCount(cellCount), 0xFF);
+        CellStates loaded;
+        CellStatesLoad(loaded, cellCount, bytes.data());
+        CHECK(loaded.marked == cellCount);
+        CHECK(CellStatesGet(loaded, cellCount - 1) == CELL_FLAGGED);
+        if (cellCount < CELL_MAX_COUNT) {
+            CHECK(CellStatesGet(loaded, cellCount) == CELL_EMPTY);
+            CHECK(CellStatesFindFirst(loaded, CELL_MAX_COUNT, CELL_EMPTY) == cellCount);
+        }
+
+        // Saved again, the extra bits are gone.
+        std::vector<uint8_t> saved(bytes.size());
+        CellStatesSave(loaded, cellCount, saved.data());
+        if (cellCount % 4 != 0) {
+            CHECK(saved.back() == (uint8_t)((1u << (2 * (cellCount % 4))) - 1));
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Main
+//--------------------------------------------------------------------------------------
+
+int main() {
+    const struct { const char* name; void (*run)(); } tests[] = {
+        { "find boundaries", TestFindFirstBoundaries },
+        { "find random", TestFindFirstRandom },
+        { "save and load", TestSaveLoad },
+        { "load extra bits", TestLoadIgnoresExtraBits },
+    };
+    for (const auto& test : tests) {
+        const int before = g_failures;
+        test.run();
+        printf("%-20s %s\n", test.name, g_failures == before ? "ok" : "FAILED");
+    }
+    return g_failures == 0 ? 0 : 1;
+}
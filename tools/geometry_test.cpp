@@ -0,0 +1,200 @@
+/**
+ * @file geometry_test.cpp
+ * @brief Unit tests for the cell-geometry tables and point lookups.
+ *
+ *     geometry_test
+ *
+ * Exits non-zero if any check fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "grid_geometry.h"
+
+int g_failures = 0;
+
+#define CHECK(condition)                                                      \
+    do {                                                                      \
+        if (!(condition)) {                                                   \
+            printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            ++g_failures;                                                     \
+        }                                                                     \
+    } while (0)
+
+const int TEST_MAX_SIZE = 4096;       // Largest client width or height checked exhaustively.
+const int TEST_POINT_MAX_SIZE = 2048; // The same for grid-space round trips, which cost more.
+
+//--------------------------------------------------------------------------------------
+// Tests
+//--------------------------------------------------------------------------------------
+
+void TestEdgeTables() {
+    GridGeometry geometry;
+    for (int size = 1; size <= TEST_MAX_SIZE; ++size) {
+        for (int count = 1; count <= GRID_MAX_CELLS; ++count) {
+            CHECK(GridGeometryUpdate(geometry, size, size, count, count));
+            bool ordered = geometry.colEdge[0] == 0 && geometry.colEdge[count] == size;
+            for (int c = 0; c < count; ++c) {
+                ordered = ordered && geometry.colEdge[c] <= geometry.colEdge[c + 1];
+            }
+            CHECK(ordered);
+            CHECK(memcmp(geometry.colEdge, geometry.rowEdge, sizeof(geometry.colEdge)) == 0);
+        }
+    }
+
+    CHECK(!GridGeometryUpdate(geometry, 100, 100, 0, 6));
+    CHECK(!GridGeometryUpdate(geometry, 100, 100, 10, GRID_MAX_CELLS + 1));
+    CHECK(!GridGeometryUpdate(geometry, -1, 100, 10, 6));
+    CHECK(geometry.cols == 0 && geometry.rows == 0);
+}
+
+void TestCellIndex() {
+    // Every coordinate of every size up to TEST_MAX_SIZE, for every count: the
+    // cell found must be the one whose edges contain it, empty cells included.
+    GridGeometry geometry;
+    for (int size = 1; size <= TEST_MAX_SIZE; ++size) {
+        for (int count = 1; count <= GRID_MAX_CELLS; ++count) {
+            GridGeometryUpdate(geometry, size, 1, count, 1);
+            const int* edge = geometry.colEdge;
+            int wrong = 0;
+            for (int p = 0; p < size; ++p) {
+                const int c = GridCellIndex(p, size, count);
+                if (c < 0 || c >= count || edge[c] > p || p >= edge[c + 1]) {
+                    ++wrong;
+                }
+            }
+            if (wrong) {
+                printf("  size %d, count %d: %d coordinates in the wrong cell\n", size, count, wrong);
+                ++g_failures;
+            }
+        }
+    }
+}
+
+void TestCellFromPoint() {
+    const struct { int width; int height; int cols; int rows; } grids[] = {
+        { 173, 97, 10, 6 },
+        { 100, 60, 7, 64 },
+        { 3, 2, 64, 64 },
+    };
+    for (const auto& grid : grids) {
+        GridGeometry geometry;
+        GridGeometryUpdate(geometry, grid.width, grid.height, grid.cols, grid.rows);
+        for (int y = 0; y < grid.height; ++y) {
+            for (int x = 0; x < grid.width; ++x) {
+                int col = -1, row = -1;
+                CHECK(GridCellFromPoint(geometry, x, y, &col, &row));
+                int left, top, right, bottom;
+                GridCellBounds(geometry, col, row, &left, &top, &right, &bottom);
+                CHECK(left <= x && x < right && top <= y && y < bottom);
+            }
+        }
+        int col = -1, row = -1;
+        CHECK(!GridCellFromPoint(geometry, -1, 0, &col, &row));
+        CHECK(!GridCellFromPoint(geometry, 0, -1, &col, &row));
+        CHECK(!GridCellFromPoint(geometry, grid.width, 0, &col, &row));
+        CHECK(!GridCellFromPoint(geometry, 0, grid.height, &col, &row));
+    }
+}
+
+void TestPointRoundTrip() {
+    // Every pixel of every size up to TEST_POINT_MAX_SIZE, for every count, comes
+    // back to itself through grid space. The axes are independent, so one is enough.
+    GridGeometry geometry;
+    for (int size = 1; size <= TEST_POINT_MAX_SIZE; ++size) {
+        for (int count = 1; count <= GRID_MAX_CELLS; ++count) {
+            GridGeometryUpdate(geometry, size, 1, count, 1);
+            int wrong = 0;
+            for (int p = 0; p < size; ++p) {
+                int x = -1, y = -1;
+                GridPointToClient(geometry, GridPointFromClient(geometry, p, 0), &x, &y);
+                if (x != p || y != 0) {
+                    ++wrong;
+                }
+            }
+            if (wrong) {
+                printf("  size %d, count %d: %d pixels moved\n", size, count, wrong);
+                ++g_failures;
+            }
+        }
+    }
+
+    // Whole two-dimensional grids, and points outside them clamped to the border.
+    GridGeometryUpdate(geometry, 173, 97, 10, 6);
+    for (int y = 0; y < geometry.height; ++y) {
+        for (int x = 0; x < geometry.width; ++x) {
+            int backX = -1, backY = -1;
+            GridPointToClient(geometry, GridPointFromClient(geometry, x, y), &backX, &backY);
+            CHECK(backX == x && backY == y);
+        }
+    }
+    int x = -1, y = -1;
+    GridPointToClient(geometry, GridPointFromClient(geometry, -5, geometry.height + 5), &x, &y);
+    CHECK(x == 0 && y == geometry.height - 1);
+}
+
+void TestPointKeepsCell() {
+    // A point placed on any pixel stays in the same cell when the window is
+    // resized, as long as that cell still has pixels at the new size.
+    const int sizes[] = { 60, 97, 144, 173, 240, 384, 1000, 1080, 2160, 3840 };
+    const int counts[] = { 1, 5, 6, 7, 10, 64 };
+    for (int count : counts) {
+        for (int from : sizes) {
+            GridGeometry before;
+            GridGeometryUpdate(before, from, 1, count, 1);
+            for (int to : sizes) {
+                GridGeometry after;
+                GridGeometryUpdate(after, to, 1, count, 1);
+                int wrong = 0;
+                for (int p = 0; p < from; ++p) {
+                    const int cell = GridCellIndex(p, from, count);
+                    if (after.colEdge[cell] == after.colEdge[cell + 1]) {
+                        continue; // The cell is empty at the new size.
+                    }
+                    int x = -1, y = -1;
+                    GridPointToClient(after, GridPointFromClient(before, p, 0), &x, &y);
+                    if (x < 0 || x >= to || GridCellIndex(x, to, count) != cell) {
+                        ++wrong;
+                    }
+                }
+                if (wrong) {
+                    printf("  %d cells, %d to %d pixels: %d points changed cell\n", count, from, to, wrong);
+                    ++g_failures;
+                }
+            }
+        }
+    }
+
+    // Resizing away and back returns every point to its pixel.
+    GridGeometry original, resized;
+    GridGeometryUpdate(original, 240, 144, 10, 6);
+    GridGeometryUpdate(resized, 3840, 2160, 10, 6);
+    for (int y = 0; y < original.height; ++y) {
+        for (int x = 0; x < original.width; ++x) {
+            int bigX, bigY, backX, backY;
+            GridPointToClient(resized, GridPointFromClient(original, x, y), &bigX, &bigY);
+            GridPointToClient(original, GridPointFromClient(resized, bigX, bigY), &backX, &backY);
+            CHECK(backX == x && backY == y);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Main
+//--------------------------------------------------------------------------------------
+
+int main() {
+    const struct { const char* name; void (*run)(); } tests[] = {
+        { "edge tables", TestEdgeTables },
+        { "cell index", TestCellIndex },
+        { "cell from point", TestCellFromPoint },
+        { "point round trip", TestPointRoundTrip },
+        { "point keeps cell", TestPointKeepsCell },
+    };
+    for (const auto& test : tests) {
+        const int before = g_failures;
+        test.run();
+        printf("%-20s %s\n", test.name, g_failures == before ? "ok" : "FAILED");
+    }
+    return g_failures == 0 ? 0 : 1;
+}
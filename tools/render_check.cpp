@@ -0,0 +1,256 @@
+/**
+ * @file render_check.cpp
+ * @brief Headless golden-image check and frame timing for the overlay renderer.
+ *
+ * Renders the overlay (grid, labels, cell marks, dot) through the same RenderPlan
+ * and MemoryBackend the /render option uses, for a matrix of sizes, grids and
+ * presentation modes.
+ * Each frame is compared with the matching PAM image in golden/, alpha
+ * included, and the per-frame render time is reported as p50/p99. Runs
+ * anywhere the headers compile; no Windows needed.
+ *
+ *     render_check [--update] [--golden DIR] [--out DIR] [--tolerance N] [--frames N]
+ *
+ * --update rewrites the golden images from the current renderer. Frames that
+ * don't match are written to the --out directory for inspection. Exits
+ * non-zero if any frame differs by more than the tolerance.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "grid_plan.h"
+#include "test_scene.h"
+
+//--------------------------------------------------------------------------------------
+// Cases
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief One frame of the matrix. Cases without golden images are timed only.
+ */
+struct RenderCase {
+    int width;
+    int height;
+    int cols;
+    int rows;
+    TestMode mode;
+    int scale;   // DPI scale, in whole multiples of 96 DPI.
+    bool golden; // Compared against golden/<name>.pam.
+};
+
+const RenderCase RENDER_CASES[] = {
+    // Small frames cover every mode; odd sizes exercise uneven edge tables.
+    { 100, 60, 10, 6, TEST_MODE_COLOR_KEY, 1, true },
+    { 100, 60, 10, 6, TEST_MODE_ALPHA, 1, true },
+    { 100, 60, 10, 6, TEST_MODE_RESIZE, 1, true },
+    { 173, 97, 10, 6, TEST_MODE_COLOR_KEY, 1, true },
+    { 173, 97, 10, 6, TEST_MODE_ALPHA, 1, true },
+    { 173, 97, 10, 6, TEST_MODE_RESIZE, 1, true },
+    { 240, 144, 10, 6, TEST_MODE_COLOR_KEY, 2, true },
+    { 240, 144, 10, 6, TEST_MODE_ALPHA, 2, true },
+    { 173, 97, 6, 5, TEST_MODE_COLOR_KEY, 1, true },
+    { 173, 97, 6, 5, TEST_MODE_ALPHA, 1, true },
+    { 173, 97, 7, 4, TEST_MODE_ALPHA, 1, true },
+    // Real overlay sizes: a PC box on 1080p and 4K screens.
+    { 640, 384, 10, 6, TEST_MODE_COLOR_KEY, 1, false },
+    { 640, 384, 10, 6, TEST_MODE_ALPHA, 1, false },
+    { 1280, 768, 10, 6, TEST_MODE_COLOR_KEY, 2, false },
+    { 1280, 768, 10, 6, TEST_MODE_ALPHA, 2, false },
+    { 3840, 2160, 10, 6, TEST_MODE_ALPHA, 2, false },
+};
+
+/**
+ * @brief Returns the case's file name stem, e.g. "173x97_10x6_alpha".
+ */
+std::string CaseName(const RenderCase& c) {
+    char name[64];
+    snprintf(name, sizeof(name), "%dx%d_%dx%d_%s", c.width, c.height, c.cols, c.rows, TEST_MODE_NAMES[c.mode]);
+    return name;
+}
+
+//--------------------------------------------------------------------------------------
+// PAM Files
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief Reads a binary PAM as written by RasterWritePam.
+ * @return false if the file is missing or not a 255-max RGB_ALPHA image.
+ */
+bool ReadPam(const std::string& path, int* width, int* height, std::vector<uint8_t>& rgba) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    int depth = 0, maxValue = 0;
+    char tupleType[16] = {};
+    bool ok = fscanf(file, "P7 WIDTH %d HEIGHT %d DEPTH %d MAXVAL %d TUPLTYPE %15s ENDHDR", width, height, &depth,
+                     &maxValue, tupleType) == 5 &&
+              depth == 4 && maxValue == 255 && strcmp(tupleType, "RGB_ALPHA") == 0 && *width > 0 && *height > 0 &&
+              fgetc(file) != EOF;
+    if (ok) {
+        rgba.resize((size_t)*width * *height * 4);
+        ok = fread(rgba.data(), 1, rgba.size(), file) == rgba.size();
+    }
+    fclose(file);
+    return ok;
+}
+
+/**
+ * @brief Writes the surface to @p path as a PAM.
+ */
+bool WritePam(const std::string& path, const RasterSurface& surface) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool written = RasterWritePam(surface, file);
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * @brief Counts pixels where any channel, alpha included, differs from the golden
+ *        image by more than @p tolerance, and the largest difference seen. The
+ *        golden colors are premultiplied again before comparing, which restores
+ *        the rendered values exactly.
+ */
+long CountMismatches(const RasterSurface& surface, const std::vector<uint8_t>& golden, int tolerance, int* maxDiff) {
+    long mismatches = 0;
+    *maxDiff = 0;
+    for (int y = 0; y < surface.height; ++y) {
+        const uint32_t* row = surface.pixels + (intptr_t)y * surface.stride;
+        const uint8_t* expected = &golden[(size_t)y * surface.width * 4];
+        for (int x = 0; x < surface.width; ++x, expected += 4) {
+            const int alpha = expected[3];
+            int worst = abs((int)(row[x] >> 24) - alpha);
+            for (int ch = 0; ch < 3; ++ch) {
+                const int actual = (int)(row[x] >> (16 - 8 * ch)) & 0xFF;
+                worst = std::max(worst, abs(actual - (expected[ch] * alpha + 127) / 255));
+            }
+            *maxDiff = std::max(*maxDiff, worst);
+            if (worst > tolerance) {
+                ++mismatches;
+            }
+        }
+    }
+    return mismatches;
+}
+
+//--------------------------------------------------------------------------------------
+// Timing
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief Returns the @p percentile (0-100) of the samples, nearest rank.
+ */
+double Percentile(std::vector<double> samples, double percentile) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t rank = (size_t)(percentile / 100.0 * samples.size() + 0.5);
+    rank = rank < 1 ? 1 : (rank > samples.size() ? samples.size() : rank);
+    return samples[rank - 1];
+}
+
+/**
+ * @brief Renders the scene @p frames times, recompiling the plan each time as a
+ *        changed frame would, and returns the per-frame times in microseconds.
+ */
+std::vector<double> TimeFrames(RenderPlan& plan, MemoryBackend& backend, const GridScene& scene, int frames) {
+    std::vector<double> times;
+    times.reserve(frames);
+    for (int i = 0; i < frames; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        RenderPlanBuild(plan, scene);
+        RenderPlanReplay(plan, backend);
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return times;
+}
+
+//--------------------------------------------------------------------------------------
+// Main
+//--------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    std::string goldenDir = "golden";
+    std::string outDir = ".";
+    bool update = false;
+    int tolerance = 2;
+    int frames = 50;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (strcmp(argv[i], "--golden") == 0 && hasValue) {
+            goldenDir = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            outDir = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+            tolerance = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frames = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--update] [--golden DIR] [--out DIR] [--tolerance N] [--frames N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    GlyphAtlas atlas;
+    TestAtlasBuild(atlas);
+    GlyphStrip strip;
+
+    int failures = 0;
+    printf("%-28s %-10s %10s %10s\n", "case", "golden", "p50 us", "p99 us");
+    for (const RenderCase& c : RENDER_CASES) {
+        const std::string name = CaseName(c);
+        GridGeometry geometry;
+        GridGeometryUpdate(geometry, c.width, c.height, c.cols, c.rows);
+        CellStates cells;
+        TestCellsMark(cells, geometry);
+        const GridScene scene = TestSceneBuild(geometry, c.mode, c.scale, &atlas, &strip, &cells, true);
+
+        RenderPlan plan;
+        MemoryBackend backend;
+        RenderPlanDraw(plan, backend, scene);
+
+        const char* status = "-";
+        if (c.golden) {
+            const std::string goldenPath = goldenDir + "/" + name + ".pam";
+            int width = 0, height = 0, maxDiff = 0;
+            std::vector<uint8_t> golden;
+            if (update) {
+                status = WritePam(goldenPath, backend.Surface()) ? "updated" : "WRITE FAIL";
+            } else if (!ReadPam(goldenPath, &width, &height, golden)) {
+                status = "MISSING";
+            } else if (width != c.width || height != c.height) {
+                status = "SIZE";
+            } else if (CountMismatches(backend.Surface(), golden, tolerance, &maxDiff) > 0) {
+                status = "DIFF";
+            } else {
+                status = "ok";
+            }
+            if (strcmp(status, "ok") != 0 && strcmp(status, "updated") != 0) {
+                ++failures;
+                WritePam(outDir + "/" + name + ".actual.pam", backend.Surface());
+            }
+            if (maxDiff > 0) {
+                printf("  %s: max channel difference %d\n", name.c_str(), maxDiff);
+            }
+        }
+
+        const std::vector<double> times = TimeFrames(plan, backend, scene, frames);
+        printf("%-28s %-10s %10.1f %10.1f\n", name.c_str(), status, Percentile(times, 50), Percentile(times, 99));
+    }
+
+    if (failures > 0) {
+        printf("%d frame(s) did not match; actual images written to %s\n", failures, outDir.c_str());
+        return 1;
+    }
+    return 0;
+}
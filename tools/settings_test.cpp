@@ -0,0 +1,392 @@
+/**
+ * @file settings_test.cpp
+ * @brief Unit tests and timings for the settings encoding and the file store.
+ *
+ *     settings_test [--bench]
+ *
+ * Exits non-zero if any check fails. With --bench, also times encoding,
+ * decoding and durable file writes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "grid_settings.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+int g_failures = 0;
+
+#define CHECK(condition)                                                      \
+    do {                                                                      \
+        if (!(condition)) {                                                   \
+            printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            ++g_failures;                                                     \
+        }                                                                     \
+    } while (0)
+
+//--------------------------------------------------------------------------------------
+// Helpers
+//--------------------------------------------------------------------------------------
+
+/**
+ * @brief A layout that differs from the defaults in every field.
+ */
+LayoutProfile TestLayout(const char* name, int offset) {
+    LayoutProfile layout;
+    layout.name = name;
+    layout.windowLeft = -1200 + offset;
+    layout.windowTop = 40 + offset;
+    layout.windowRight = -200 + offset;
+    layout.windowBottom = 640 + offset;
+    layout.dotSet = true;
+    layout.dot.col = 7.5;
+    layout.dot.row = 4.25;
+    layout.cols = 8;
+    layout.rows = 5;
+    CellStatesSet(layout.cells, 0, CELL_EGG);
+    CellStatesSet(layout.cells, 9, CELL_HATCHED);
+    CellStatesSet(layout.cells, 39, CELL_FLAGGED);
+    return layout;
+}
+
+OverlaySettings TestSettings() {
+    OverlaySettings settings;
+    settings.profiles.clear();
+    settings.profiles.push_back(TestLayout("Box", 0));
+    settings.profiles.push_back(TestLayout("Bag \xC3\xA9", 13));
+    settings.activeProfile = 1;
+    settings.followGame = true;
+    settings.autoHide = true;
+    return settings;
+}
+
+bool SameCells(const LayoutProfile& a, const LayoutProfile& b) {
+    for (int i = 0; i < a.cols * a.rows; ++i) {
+        if (CellStatesGet(a.cells, i) != CellStatesGet(b.cells, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SameLayout(const LayoutProfile& a, const LayoutProfile& b) {
+    return a.name == b.name && a.windowLeft == b.windowLeft && a.windowTop == b.windowTop &&
+           a.windowRight == b.windowRight && a.windowBottom == b.windowBottom && a.dotSet == b.dotSet &&
+           a.dot.col == b.dot.col && a.dot.row == b.dot.row && a.cols == b.cols && a.rows == b.rows && SameCells(a, b);
+}
+
+/**
+ * @brief Wraps raw records in a settings header with the given version and a valid checksum.
+ */
+std::vector<uint8_t> TestFile(uint16_t version, const std::vector<uint8_t>& records) {
+    std::vector<uint8_t> out = { 'G', 'O', 'S', 'F' };
+    SettingsPutU16(out, version);
+    SettingsPutU16(out, 0);
+    SettingsPutU32(out, SettingsCrc32(records.data(), records.size()));
+    out.insert(out.end(), records.begin(), records.end());
+    return out;
+}
+
+/**
+ * @brief A fresh directory for store files, removed by the caller.
+ */
+std::string TestTempDir() {
+#if defined(__unix__) || defined(__APPLE__)
+    char pattern[] = "/tmp/settings_test.XXXXXX";
+    const char* dir = mkdtemp(pattern);
+    return dir ? dir : ".";
+#else
+    return ".";
+#endif
+}
+
+bool FileExists(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file) {
+        fclose(file);
+    }
+    return file != NULL;
+}
+
+/**
+ * @brief A file store whose commit or rename step can be made to fail, as a
+ *        crash or a full disk would.
+ */
+class FailingFileStore : public FileSettingsStore {
+public:
+    explicit FailingFileStore(const std::string& path) : FileSettingsStore(path) {}
+
+    bool failCommit = false;
+    bool failRename = false;
+
+protected:
+    bool CommitFile(FILE* file) override {
+        return !failCommit && FileSettingsStore::CommitFile(file);
+    }
+    bool RenamePath(const char* from, const char* to) override {
+        return !failRename && FileSettingsStore::RenamePath(from, to);
+    }
+};
+
+//--------------------------------------------------------------------------------------
+// Encoding
+//--------------------------------------------------------------------------------------
+
+void TestRoundTrip() {
+    const OverlaySettings settings = TestSettings();
+    std::vector<uint8_t> bytes;
+    SettingsEncode(settings, bytes);
+
+    OverlaySettings decoded;
+    CHECK(SettingsDecode(bytes.data(), bytes.size(), decoded));
+    CHECK(decoded.version == SETTINGS_VERSION);
+    CHECK(decoded.profiles.size() == 2);
+    CHECK(decoded.activeProfile == 1);
+    CHECK(decoded.followGame && decoded.autoHide);
+    CHECK(decoded.unknownRecords.empty());
+    for (size_t i = 0; i < decoded.profiles.size() && i < settings.profiles.size(); ++i) {
+        CHECK(SameLayout(decoded.profiles[i], settings.profiles[i]));
+    }
+
+    OverlaySettings defaults;
+    SettingsEncode(OverlaySettings(), bytes);
+    CHECK(SettingsDecode(bytes.data(), bytes.size(), defaults));
+    CHECK(defaults.profiles.size() == 1 && SameLayout(defaults.profiles[0], LayoutProfile()));
+}
+
+void TestStableBytes() {
+    // Decoding and re-encoding must reproduce the file byte for byte, so repeated
+    // saves neither grow it nor turn known records into unknown ones.
+    std::vector<uint8_t> first;
+    SettingsEncode(TestSettings(), first);
+    std::vector<uint8_t> bytes = first;
+    for (int save = 0; save < 3; ++save) {
+        OverlaySettings settings;
+        CHECK(SettingsDecode(bytes.data(), bytes.size(), settings));
+        CHECK(settings.unknownRecords.empty());
+        CHECK(settings.profiles[settings.activeProfile].dot.col == 7.5);
+        SettingsEncode(settings, bytes);
+        CHECK(bytes == first);
+    }
+}
+
+void TestRejectsDamage() {
+    std::vector<uint8_t> bytes;
+    SettingsEncode(TestSettings(), bytes);
+    OverlaySettings untouched;
+
+    std::vector<uint8_t> flipped = bytes;
+    flipped[bytes.size() / 2] ^= 0x10;
+    CHECK(!SettingsDecode(flipped.data(), flipped.size(), untouched));
+
+    std::vector<uint8_t> magic = bytes;
+    magic[0] = 'X';
+    CHECK(!SettingsDecode(magic.data(), magic.size(), untouched));
+
+    CHECK(!SettingsDecode(bytes.data(), bytes.size() - 3, untouched)); // Fails the checksum.
+    CHECK(!SettingsDecode(bytes.data(), SETTINGS_HEADER_SIZE - 1, untouched));
+
+    // A truncated record with a matching checksum is still rejected.
+    std::vector<uint8_t> records = { SETTINGS_TAG_WINDOW, 0, 16, 0, 1, 2, 3 };
+    std::vector<uint8_t> truncated = TestFile(SETTINGS_VERSION, records);
+    CHECK(!SettingsDecode(truncated.data(), truncated.size(), untouched));
+
+    CHECK(untouched.profiles.size() == 1 && SameLayout(untouched.profiles[0], LayoutProfile()));
+}
+
+void TestMissingRecords() {
+    // Only a window record: everything else keeps its default.
+    std::vector<uint8_t> records;
+    size_t record = SettingsBeginRecord(records, SETTINGS_TAG_WINDOW);
+    SettingsPutU32(records, 0);
+    SettingsPutU32(records, 0);
+    SettingsPutU32(records, 800);
+    SettingsPutU32(records, 480);
+    SettingsEndRecord(records, record);
+    // Cell marks for a grid size other than the one in effect are dropped.
+    record = SettingsBeginRecord(records, SETTINGS_TAG_CELLS);
+    records.insert(records.end(), 3, 0xFF);
+    SettingsEndRecord(records, record);
+    const std::vector<uint8_t> bytes = TestFile(SETTINGS_VERSION, records);
+
+    OverlaySettings settings;
+    CHECK(SettingsDecode(bytes.data(), bytes.size(), settings));
+    CHECK(settings.profiles.size() == 1 && !settings.followGame && !settings.autoHide);
+    LayoutProfile expected;
+    expected.windowLeft = 0;
+    expected.windowTop = 0;
+    expected.windowRight = 800;
+    expected.windowBottom = 480;
+    CHECK(SameLayout(settings.profiles[0], expected));
+    CHECK(settings.profiles[0].cells.marked == 0);
+}
+
+void TestVersion1() {
+    // Version 1: top-level window, pixel dot and grid only.
+    std::vector<uint8_t> records;
+    size_t record = SettingsBeginRecord(records, SETTINGS_TAG_WINDOW);
+    SettingsPutU32(records, 0);
+    SettingsPutU32(records, 0);
+    SettingsPutU32(records, 800);
+    SettingsPutU32(records, 480);
+    SettingsEndRecord(records, record);
+    record = SettingsBeginRecord(records, SETTINGS_TAG_DOT);
+    records.push_back(1);
+    SettingsPutU32(records, 600); // Middle of column 7 in an 80 px wide grid.
+    SettingsPutU32(records, 360); // Middle of row 4 in an 80 px tall grid.
+    SettingsEndRecord(records, record);
+    record = SettingsBeginRecord(records, SETTINGS_TAG_GRID);
+    SettingsPutU16(records, 10);
+    SettingsPutU16(records, 6);
+    SettingsEndRecord(records, record);
+    const std::vector<uint8_t> bytes = TestFile(1, records);
+
+    OverlaySettings settings;
+    CHECK(SettingsDecode(bytes.data(), bytes.size(), settings));
+    CHECK(settings.version == 1);
+    CHECK(settings.profiles.size() == 1 && settings.activeProfile == 0);
+    const LayoutProfile& layout = settings.profiles[0];
+    CHECK(layout.windowRight == 800 && layout.windowBottom == 480);
+    CHECK(layout.dotSet);
+    CHECK(layout.cols == 10 && layout.rows == 6);
+    CHECK(fabs(layout.dot.col - 7.5) < 0.02 && fabs(layout.dot.row - 4.5) < 0.02);
+}
+
+void TestUnknownRecords() {
+    std::vector<uint8_t> bytes;
+    SettingsEncode(TestSettings(), bytes);
+    // A record from a future version, appended with a fixed-up checksum.
+    std::vector<uint8_t> records(bytes.begin() + SETTINGS_HEADER_SIZE, bytes.end());
+    const std::vector<uint8_t> future = { 0x40, 0x00, 0x03, 0x00, 'n', 'e', 'w' };
+    records.insert(records.end(), future.begin(), future.end());
+    const std::vector<uint8_t> newer = TestFile(SETTINGS_VERSION + 1, records);
+
+    OverlaySettings settings;
+    CHECK(SettingsDecode(newer.data(), newer.size(), settings));
+    CHECK(settings.unknownRecords == future);
+
+    // Kept exactly once when written back.
+    std::vector<uint8_t> saved;
+    SettingsEncode(settings, saved);
+    OverlaySettings reread;
+    CHECK(SettingsDecode(saved.data(), saved.size(), reread));
+    CHECK(reread.unknownRecords == future);
+    CHECK(saved.size() == bytes.size() + future.size());
+}
+
+//--------------------------------------------------------------------------------------
+// File Store
+//--------------------------------------------------------------------------------------
+
+void TestFileStore() {
+    const std::string dir = TestTempDir();
+    const std::string path = dir + "/settings.dat";
+
+    FileSettingsStore store(path);
+    std::vector<uint8_t> bytes;
+    CHECK(!store.Read(bytes)); // Nothing saved yet.
+
+    std::vector<uint8_t> first;
+    SettingsEncode(TestSettings(), first);
+    CHECK(store.Write(first));
+    CHECK(store.Read(bytes) && bytes == first);
+    CHECK(!FileExists(path + ".tmp"));
+
+    std::vector<uint8_t> second;
+    SettingsEncode(OverlaySettings(), second);
+    CHECK(store.Write(second));
+    CHECK(store.Read(bytes) && bytes == second);
+
+    // A write that fails part-way leaves the previous file and no temporary behind.
+    FailingFileStore failing(path);
+    failing.failCommit = true;
+    CHECK(!failing.Write(first));
+    CHECK(store.Read(bytes) && bytes == second);
+    CHECK(!FileExists(path + ".tmp"));
+    failing.failCommit = false;
+    failing.failRename = true;
+    CHECK(!failing.Write(first));
+    CHECK(store.Read(bytes) && bytes == second);
+    CHECK(!FileExists(path + ".tmp"));
+
+    // A file that grew past the size limit is read only as far as the limit allows, and rejected.
+    std::vector<uint8_t> huge(SETTINGS_MAX_SIZE + 8192, 0);
+    CHECK(store.Write(huge));
+    OverlaySettings settings;
+    CHECK(store.Read(bytes) && !SettingsDecode(bytes.data(), bytes.size(), settings));
+
+    remove(path.c_str());
+    if (dir != ".") {
+        remove(dir.c_str());
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Timing
+//--------------------------------------------------------------------------------------
+
+template <class Fn>
+void BenchPrint(const char* name, int iterations, Fn fn) {
+    std::vector<double> times(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        times[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::sort(times.begin(), times.end());
+    printf("  %-36s p50 %10.2f us   p99 %10.2f us\n", name, times[iterations / 2], times[iterations * 99 / 100]);
+}
+
+void BenchSettings() {
+    printf("[settings]\n");
+    const OverlaySettings settings = TestSettings();
+    std::vector<uint8_t> bytes;
+    SettingsEncode(settings, bytes);
+    printf("  %zu bytes with %zu profiles\n", bytes.size(), settings.profiles.size());
+    BenchPrint("encode", 10000, [&]() { SettingsEncode(settings, bytes); });
+    OverlaySettings decoded;
+    BenchPrint("decode", 10000, [&]() { SettingsDecode(bytes.data(), bytes.size(), decoded); });
+
+    const std::string dir = TestTempDir();
+    const std::string path = dir + "/settings.dat";
+    FileSettingsStore store(path);
+    BenchPrint("file write (temp + fsync + rename)", 200, [&]() { store.Write(bytes); });
+    std::vector<uint8_t> read;
+    BenchPrint("file read", 2000, [&]() { store.Read(read); });
+    remove(path.c_str());
+    if (dir != ".") {
+        remove(dir.c_str());
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Main
+//--------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    const struct { const char* name; void (*run)(); } tests[] = {
+        { "round trip", TestRoundTrip },
+        { "stable bytes", TestStableBytes },
+        { "rejects damage", TestRejectsDamage },
+        { "missing records", TestMissingRecords },
+        { "version 1", TestVersion1 },
+        { "unknown records", TestUnknownRecords },
+        { "file store", TestFileStore },
+    };
+    for (const auto& test : tests) {
+        const int before = g_failures;
+        test.run();
+        printf("%-20s %s\n", test.name, g_failures == before ? "ok" : "FAILED");
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        BenchSettings();
+    }
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_scene.h
+ * @brief Builds overlay scenes like run.cpp does, without Windows, for the
+ *        portable checks and benchmarks in this directory.
+ *
+ * The label atlas comes from a built-in 5x7 bitmap font instead of GDI, so
+ * frames are identical on every machine. Colors and sizes mirror the
+ * constants at the top of run.cpp.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "grid_geometry.h"
+#include "grid_cells.h"
+#include "grid_glyphs.h"
+#include "grid_render.h"
+
+/**
+ * @brief How the overlay is being presented, which decides its background,
+ *        edge quality and whether marks are fills or outlines.
+ */
+enum TestMode {
+    TEST_MODE_COLOR_KEY, // Locked, LWA_COLORKEY: opaque key background, crisp edges, outlined marks.
+    TEST_MODE_ALPHA,     // Locked, /alpha: transparent background, anti-aliased, translucent marks.
+    TEST_MODE_RESIZE,    // Interactive mode: opaque face color, anti-aliased, hover highlight.
+};
+
+const char* const TEST_MODE_NAMES[] = { "key", "alpha", "resize" };
+
+// Digits as 5x7 bitmaps, '#' for ink.
+const char* const TEST_FONT_DIGITS[10][7] = {
+    { " ### ", "#   #", "#  ##", "# # #", "##  #", "#   #", " ### " },
+    { "  #  ", " ##  ", "  #  ", "  #  ", "  #  ", "  #  ", " ### " },
+    { " ### ", "#   #", "    #", "   # ", "  #  ", " #   ", "#####" },
+    { "#####", "   # ", "  #  ", "   # ", "    #", "#   #", " ### " },
+    { "   # ", "  ## ", " # # ", "#  # ", "#####", "   # ", "   # " },
+    { "#####", "#    ", "#### ", "    #", "    #", "#   #", " ### " },
+    { "  ## ", " #   ", "#    ", "#### ", "#   #", "#   #", " ### " },
+    { "#####", "    #", "   # ", "  #  ", " #   ", " #   ", " #   " },
+    { " ### ", "#   #", "#   #", " ### ", "#   #", "#   #", " ### " },
+    { " ### ", "#   #", "#   #", " ####", "    #", "   # ", " ##  " },
+};
+
+const int TEST_FONT_HEIGHT = 64; // Reference height, like LABEL_ATLAS_FONT_HEIGHT.
+const int TEST_FONT_SPREAD = 8;  // Like LABEL_ATLAS_SPREAD.
+const int TEST_FONT_DOT = 8;     // Reference pixels per bitmap dot.
+
+/**
+ * @brief Builds the digit atlas from the bitmap font: each dot becomes an 8x8
+ *        block, with a dot of side bearing and half a dot of leading.
+ */
+inline void TestAtlasBuild(GlyphAtlas& atlas) {
+    const int lead = TEST_FONT_DOT / 2;
+    int advances[10];
+    for (int d = 0; d < 10; ++d) {
+        advances[d] = 6 * TEST_FONT_DOT;
+    }
+    GlyphAtlasReset(atlas, TEST_FONT_HEIGHT, advances, 7 * TEST_FONT_DOT + 2 * lead, TEST_FONT_SPREAD);
+
+    std::vector<uint8_t> coverage((size_t)atlas.width * atlas.height, 0);
+    for (int d = 0; d < 10; ++d) {
+        for (int row = 0; row < 7; ++row) {
+            for (int col = 0; col < 5; ++col) {
+                if (TEST_FONT_DIGITS[d][row][col] != '#') {
+                    continue;
+                }
+                const int x0 = atlas.glyphX[d] + TEST_FONT_DOT / 2 + col * TEST_FONT_DOT;
+                const int y0 = atlas.pad + lead + row * TEST_FONT_DOT;
+                for (int y = y0; y < y0 + TEST_FONT_DOT; ++y) {
+                    memset(&coverage[(size_t)y * atlas.width + x0], 255, TEST_FONT_DOT);
+                }
+            }
+        }
+    }
+    GlyphAtlasBuildSdf(atlas, coverage.data());
+}
+
+/**
+ * @brief Marks a fixed spread of cells: eggs along the first row, a hatched and
+ *        a flagged cell further in. Works for any grid size.
+ */
+inline void TestCellsMark(CellStates& cells, const GridGeometry& geometry) {
+    CellStatesClear(cells);
+    const int count = geometry.cols * geometry.rows;
+    for (int i = 0; i < geometry.cols && i < 3; ++i) {
+        CellStatesSet(cells, i, CELL_EGG);
+    }
+    if (count > geometry.cols + 1) {
+        CellStatesSet(cells, geometry.cols + 1, CELL_HATCHED);
+    }
+    if (count > 2 * geometry.cols + 2) {
+        CellStatesSet(cells, 2 * geometry.cols + 2, CELL_FLAGGED);
+    }
+}
+
+/**
+ * @brief Fills in a scene the way run.cpp's BuildScene does for @p mode.
+ * @param scale DPI scale as a whole multiple of 96 DPI.
+ * @param strip Strip cache for @p atlas.
+ * @param cells Marks to draw, or NULL for none; the first egg blinks.
+ * @param dot Whether the custom dot is placed (in the middle of the grid).
+ */
+inline GridScene TestSceneBuild(const GridGeometry& geometry, TestMode mode, int scale, const GlyphAtlas* atlas,
+                                GlyphStrip* strip, const CellStates* cells, bool dot) {
+    const bool translucent = mode != TEST_MODE_COLOR_KEY;
+    const uint8_t markAlpha = translucent ? 96 : 255;
+
+    GridScene scene = {};
+    scene.geometry = &geometry;
+    scene.labelFontHeight = geometry.rows > 0 ? geometry.rowEdge[1] * 3 / 5 : 0;
+    scene.labelAtlas = geometry.rows > 0 ? atlas : NULL;
+    scene.labelStrip = strip;
+    scene.cells = cells;
+    scene.translucent = translucent;
+    scene.cellColors[CELL_EGG] = RasterArgb(markAlpha, 255, 215, 0);
+    scene.cellColors[CELL_HATCHED] = RasterArgb(markAlpha, 0, 200, 83);
+    scene.cellColors[CELL_FLAGGED] = RasterArgb(markAlpha, 255, 64, 129);
+    scene.cellOutlineWidth = 3 * scale;
+    scene.blinkCell = cells ? CellStatesFindFirst(*cells, geometry.cols * geometry.rows, CELL_EGG) : -1;
+    scene.blinkColor = RasterArgb(translucent ? 80 : 255, 255, 255, 255);
+    scene.hoverCol = mode == TEST_MODE_RESIZE && geometry.cols > 2 ? 2 : -1;
+    scene.hoverRow = mode == TEST_MODE_RESIZE && geometry.rows > 1 ? 1 : -1;
+    scene.hoverColor = RasterArgb(48, 255, 255, 255);
+    scene.dotSet = dot;
+    scene.dotX = geometry.width / 2 + geometry.width / 37;
+    scene.dotY = geometry.height / 2 + geometry.height / 23;
+    scene.dotRadius = 5 * scale;
+    scene.dotHaloRadius = 10 * scale;
+    scene.dotHaloColor = RasterArgb(72, 255, 0, 0);
+    scene.lineWidth = scale;
+    scene.antialias = translucent;
+    scene.background = mode == TEST_MODE_ALPHA ? 0 : (mode == TEST_MODE_RESIZE ? RasterArgb(255, 240, 240, 240)
+                                                                              : RasterArgb(255, 0, 0, 1));
+    scene.gridColor = RasterArgb(255, 138, 43, 226);
+    scene.labelColor = RasterArgb(255, 192, 192, 192);
+    scene.dotColor = RasterArgb(255, 255, 0, 0);
+    return scene;
+}